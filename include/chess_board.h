@@ -1,7 +1,9 @@
 #ifndef CHESS_BOARD_H
 #define CHESS_BOARD_H
 
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 #include <iostream>
 #include <sstream>
@@ -12,18 +14,45 @@ public:
     board(const std::string &initialFen);
     void reset();
     void setFromFEN(const std::string &newFen);
+    // Squares in a1, b1, ... h8 order ('\0' for empty); rights and file
+    // as returned by castlingRights() and enPassantFile().
+    void setPosition(const char squares[64], char side, int rights, int enPassantCol);
     void applyMoves(const std::vector<std::string> &moves);
-    std::string getBestMove(char player);
+    void applyMove(const std::string &move);
     void printBoard() const;
 
+    std::vector<std::string> generateLegalMoves(char player) const;
+    bool isKingInCheck(char player) const;
+
+    char pieceAt(int row, int col) const { return boardState[row][col]; }
+    uint64_t hashKey(char player) const;
+    uint64_t pawnHashKey() const { return pawnKey; }
+
+    // Castling rights as KQkq in bits 0-3, and the en passant file or -1.
+    int castlingRights() const;
+    int enPassantFile() const { return enPassantTarget.second; }
+    char sideToMove() const { return activeSide; }
+
 private:
     std::string fen;
     char boardState[8][8];
 
-    std::vector<std::string> generateLegalMoves(char player) const;
+    // Castling and en passant state travels with the board so copies
+    // made during search don't leak into each other.
+    bool whiteKingMoved, blackKingMoved;
+    bool whiteRookMoved[2]; // [queen-side, king-side]
+    bool blackRookMoved[2];
+    std::pair<int, int> enPassantTarget;
+    char activeSide; // 'w' or 'b', flipped by every applied move
+
+    // Zobrist keys of the piece placement, kept up to date by putPiece.
+    // The pawn key only covers pawns, for the pawn hash table.
+    uint64_t pieceKey;
+    uint64_t pawnKey;
+
+    void putPiece(int row, int col, char piece);
     std::vector<std::string> generateMovesForPiece(int row, int col, char piece) const;
 
-    bool isKingInCheck(char player) const;
     bool isSquareAttacked(int row, int col, char opponent) const;
     std::string convertToAlgebraic(int fromRow, int fromCol, int toRow, int toCol) const;
 };
@@ -0,0 +1,72 @@
+#ifndef EVALUATE_H
+#define EVALUATE_H
+
+#include "chess_board.h"
+#include "large_pages.h"
+#include <cstdint>
+
+// Evaluation weights in centipawns. Every term is a weight times a count
+// taken from the position, white minus black.
+enum evalParam {
+    PAWN_VALUE,
+    KNIGHT_VALUE,
+    BISHOP_VALUE,
+    ROOK_VALUE,
+    QUEEN_VALUE,
+    PAWN_ADVANCE,
+    KNIGHT_CENTRE,
+    BISHOP_CENTRE,
+    QUEEN_CENTRE,
+    KING_CENTRE,
+    BISHOP_PAIR,
+    ROOK_SEMI_OPEN_FILE,
+    PASSED_PAWN,
+    PASSED_PAWN_RANK,
+    DOUBLED_PAWN,
+    ISOLATED_PAWN,
+    BACKWARD_PAWN,
+    PAWN_SHIELD,
+    PAWN_STORM,
+    EVAL_PARAM_COUNT
+};
+
+extern int evalParams[EVAL_PARAM_COUNT];
+extern const char *evalParamNames[EVAL_PARAM_COUNT];
+
+// Everything the evaluation needs that depends only on the pawns.
+// King safety is stored per king file so it can be cached too.
+struct pawnEntry {
+    uint64_t key;
+    int16_t score;         // passed/doubled/isolated/backward, white minus black
+    uint8_t semiOpen[2];   // [white, black] files without an own pawn
+    uint8_t shield[2][8];  // own pawns in front of a king on that file
+    uint8_t storm[2][8];   // enemy pawns advancing on a king on that file
+};
+
+// Per-thread cache of pawnEntry keyed by board::pawnHashKey().
+class pawnHashTable {
+public:
+    pawnHashTable();
+    ~pawnHashTable();
+    pawnHashTable(const pawnHashTable &) = delete;
+    pawnHashTable &operator=(const pawnHashTable &) = delete;
+
+    const pawnEntry &probe(const board &position);
+    void clear();
+    double hitRate() const;
+
+private:
+    pawnEntry *table;
+    largePageInfo pageInfo;
+    uint64_t probes;
+    uint64_t hits;
+};
+
+// Static evaluation in centipawns from white's point of view.
+int evaluate(const board &position, pawnHashTable &pawns);
+
+// The count behind every weight, white minus black, bypassing the pawn
+// cache; evaluate() is the dot product of these with evalParams.
+void traceEvaluation(const board &position, int coefficients[EVAL_PARAM_COUNT]);
+
+#endif
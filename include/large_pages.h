@@ -0,0 +1,33 @@
+#ifndef LARGE_PAGES_H
+#define LARGE_PAGES_H
+
+#include <cstddef>
+#include <string>
+
+// How a large table ended up being backed by the operating system.
+struct largePageInfo {
+    size_t requestedBytes = 0;
+    size_t mappedBytes = 0;
+    bool hugetlb = false;   // explicit MAP_HUGETLB mapping
+    bool madvised = false;  // aligned allocation with MADV_HUGEPAGE
+};
+
+// Allocates at least `bytes`, preferring 2MB pages. Falls back to
+// transparent huge pages and then to a plain aligned allocation.
+// The memory is not cleared here: the first write decides which NUMA
+// node the pages land on, so the thread that will use the table
+// should be the one to touch it. Returns nullptr if every strategy fails.
+void *allocateLarge(size_t bytes, largePageInfo &info);
+void freeLarge(void *ptr, const largePageInfo &info);
+
+// Page size and NUMA node actually backing `ptr`, for `info string`.
+// Only meaningful once the memory has been touched.
+std::string describeLarge(const void *ptr, const largePageInfo &info);
+
+// Pins the calling thread to the CPUs of NUMA node `index` modulo the
+// node count, so the memory it touches afterwards stays local to it.
+// Returns false, leaving the thread unpinned, on single-node machines or
+// when /sys/devices/system/node cannot be read.
+bool pinThreadToNode(int index);
+
+#endif
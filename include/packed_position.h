@@ -0,0 +1,73 @@
+#ifndef PACKED_POSITION_H
+#define PACKED_POSITION_H
+
+#include "chess_board.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One training position in 32 bytes. Pieces are stored one nibble each,
+// in square order (a1, b1, ... h8) of the set bits of `occupancy`.
+struct packedPosition {
+    uint64_t occupancy;
+    uint8_t pieces[16];
+    uint8_t flags;     // bit 0: black to move, bits 1-4: castling KQkq
+    int8_t enPassant;  // file of the en passant square, or -1
+    int16_t score;     // search score in centipawns, white's point of view
+    int8_t result;     // 1 white won, 0 draw, -1 black won
+    uint8_t reserved[3];
+};
+
+static_assert(sizeof(packedPosition) == 32, "packedPosition must stay 32 bytes");
+
+packedPosition packPosition(const board &position, char player, int score);
+// Restores the board and returns the side to move.
+char unpackPosition(const packedPosition &packed, board &position);
+
+// Appends records to a file through an in-memory buffer. Safe to share
+// between threads.
+class packedWriter {
+public:
+    explicit packedWriter(const std::string &path);
+    ~packedWriter();
+    packedWriter(const packedWriter &) = delete;
+    packedWriter &operator=(const packedWriter &) = delete;
+
+    bool isOpen() const { return file != nullptr; }
+    void write(const std::vector<packedPosition> &positions);
+    void flush();
+    uint64_t count() const { return written; }
+
+private:
+    std::FILE *file;
+    std::vector<packedPosition> buffer;
+    std::mutex mutex;
+    std::atomic<uint64_t> written; // read by count() without the lock
+
+    void flushLocked();
+};
+
+// Read-only view of a file of records, mapped rather than copied.
+class packedFile {
+public:
+    explicit packedFile(const std::string &path);
+    ~packedFile();
+    packedFile(const packedFile &) = delete;
+    packedFile &operator=(const packedFile &) = delete;
+
+    bool isOpen() const { return opened; }
+    const packedPosition *data() const { return records; }
+    size_t size() const { return recordCount; }
+
+private:
+    const packedPosition *records;
+    size_t recordCount;
+    size_t mappedBytes;
+    bool opened;
+    std::vector<packedPosition> copy; // where there is no mmap
+};
+
+#endif
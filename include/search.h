@@ -0,0 +1,83 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "chess_board.h"
+#include "evaluate.h"
+#include "transposition_table.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+const int MATE_SCORE = 30000;
+const int MAX_PLY = 64;
+
+// Limits from a `go` command; zero means "not set".
+struct searchLimits {
+    int depth = 0;
+    uint64_t nodes = 0;
+    int movetime = 0;
+    int wtime = 0, btime = 0;
+    int winc = 0, binc = 0;
+    // Converts a time budget into a node budget at this many nodes per
+    // second, so results don't depend on machine load.
+    uint64_t nps = 0;
+    bool infinite = false; // search until stop()
+};
+
+struct searchResult {
+    std::string bestMove = "0000";
+    int score = 0;
+    int depth = 0;
+    uint64_t nodes = 0;
+};
+
+// Iterative deepening alpha-beta. Each searcher owns its pawn hash
+// table, so give every thread its own searcher; the transposition
+// table is shared.
+class searcher {
+public:
+    explicit searcher(transpositionTable &table);
+
+    // Clears a previous stop(). Call before every think(), on the thread
+    // that may later call stop(), so a stop sent right after the search
+    // starts is not lost.
+    void prepare() { stopped = false; }
+
+    // Prints UCI `info` lines to `info` when it is not null.
+    searchResult think(const board &root, char player, const searchLimits &limits, std::ostream *info);
+    void stop() { stopped = true; }
+
+    // Number of best root moves reported per iteration (UCI MultiPV).
+    void setMultiPV(int lines) { multiPV = lines < 1 ? 1 : lines; }
+
+private:
+    transpositionTable &tt;
+    pawnHashTable pawns;
+    std::atomic<bool> stopped;
+
+    uint64_t nodes;
+    uint64_t nodeLimit;
+    bool hasDeadline;
+    std::chrono::steady_clock::time_point deadline;
+    std::string rootBest;
+    std::string rootFirst; // previous iteration's best, searched first at the root
+    int multiPV;
+
+    // Root moves already reported this iteration; the next PV line
+    // searches the root without them.
+    std::vector<std::string> rootExcluded;
+
+    // Beta cutoffs by quiet moves, [side][from][to]. Kept across PV lines
+    // and iterations, halved between searches.
+    int history[2][64][64];
+
+    int alphaBeta(const board &position, char player, int depth, int ply, int alpha, int beta);
+    int quiescence(const board &position, char player, int ply, int alpha, int beta);
+    bool outOfBudget();
+    std::string principalVariation(const board &root, char player, const std::string &first, int depth) const;
+};
+
+#endif
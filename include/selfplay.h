@@ -0,0 +1,37 @@
+#ifndef SELFPLAY_H
+#define SELFPLAY_H
+
+#include <string>
+#include <vector>
+
+// `botDaru selfplay [options]`: plays two engine configurations against
+// each other in-process, one game per worker thread at a time, and
+// reports Elo with error bars and an SPRT verdict.
+//
+//   --games N            games to play, each opening with both colours (default 200)
+//   --concurrency N      worker threads (default: all cores)
+//   --openings FILE      one opening per line: UCI moves from the start
+//                        position, or a FEN
+//   --pgn FILE           append finished games as PGN
+//   --engine1 k=v,...    name, hash (MB), depth, nodes, movetime (ms),
+//   --engine2 k=v,...    tc (seconds+increment, e.g. 10+0.1), nps (cap,
+//                        needs tc or movetime)
+//   --sprt E0,E1         SPRT bounds in Elo (default 0,5)
+//   --alpha A --beta B   SPRT error rates (default 0.05)
+int runSelfplay(const std::vector<std::string> &args);
+
+// `botDaru datagen --out FILE [options]`: self-play at a low node count,
+// appending quiet positions with their score and the game result to FILE
+// as packedPosition records.
+//
+//   --games N            games to play (default 1000)
+//   --concurrency N      worker threads (default: all cores)
+//   --nodes N            nodes per move, or --depth N; 2000 nodes when
+//                        neither is given
+//   --hash MB            transposition table per engine (default 4)
+//   --random-plies N     random moves after the opening (default 8)
+//   --seed N             seed for the random moves
+//   --openings FILE      as for selfplay
+int runDatagen(const std::vector<std::string> &args);
+
+#endif
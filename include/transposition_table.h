@@ -0,0 +1,45 @@
+#ifndef TRANSPOSITION_TABLE_H
+#define TRANSPOSITION_TABLE_H
+
+#include "large_pages.h"
+#include <cstdint>
+#include <string>
+
+const uint8_t BOUND_NONE = 0;
+const uint8_t BOUND_UPPER = 1;
+const uint8_t BOUND_LOWER = 2;
+const uint8_t BOUND_EXACT = 3;
+
+struct ttEntry {
+    uint64_t key;
+    uint16_t move;
+    int16_t score;
+    int8_t depth;
+    uint8_t bound;
+};
+
+// Moves are kept as from/to squares plus promotion piece so an entry
+// stays 16 bytes; 0 means "no move".
+uint16_t encodeMove(const std::string &move);
+std::string decodeMove(uint16_t move);
+
+class transpositionTable {
+public:
+    transpositionTable();
+    ~transpositionTable();
+    transpositionTable(const transpositionTable &) = delete;
+    transpositionTable &operator=(const transpositionTable &) = delete;
+
+    void resize(size_t megabytes);
+    void clear();
+    bool probe(uint64_t key, ttEntry &entry) const;
+    void store(uint64_t key, uint16_t move, int score, int depth, uint8_t bound);
+    std::string describe() const;
+
+private:
+    ttEntry *table;
+    size_t entryCount;
+    largePageInfo pageInfo;
+};
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef TUNER_H
+#define TUNER_H
+
+#include <string>
+#include <vector>
+
+// `botDaru tune --data FILE[,FILE...] [options]`: Texel-style tuning of
+// evalParams against packedPosition files written by `datagen`. Prints
+// the tuned weights in the layout of evalParams in evaluate.cc.
+//
+//   --threads N          worker threads (default: all cores)
+//   --epochs N           gradient steps (default 300)
+//   --rate X             Adam learning rate in centipawns (default 1.0)
+//   --lambda X           weight of the game result against the search
+//                        score in the target, 0 to 1 (default 1.0)
+int runTuner(const std::vector<std::string> &args);
+
+#endif
@@ -1,5 +1,50 @@
 #include "chess_board.h"
 
+// Zobrist keys: one per piece and square, plus castling rights, en
+// passant file and side to move. Filled once at start-up from a fixed
+// seed so keys are identical from run to run.
+static uint64_t pieceZobrist[12][64];
+static uint64_t castlingZobrist[4];
+static uint64_t enPassantZobrist[8];
+static uint64_t sideZobrist;
+
+static const char zobristPieces[] = "PNBRQKpnbrqk";
+
+static int zobristIndex(char piece)
+{
+    for (int i = 0; i < 12; ++i)
+    {
+        if (zobristPieces[i] == piece)
+            return i;
+    }
+    return -1;
+}
+
+static bool initZobrist()
+{
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    auto next = [&seed]()
+    {
+        // xorshift64*
+        seed ^= seed >> 12;
+        seed ^= seed << 25;
+        seed ^= seed >> 27;
+        return seed * 0x2545F4914F6CDD1DULL;
+    };
+
+    for (auto &piece : pieceZobrist)
+        for (auto &key : piece)
+            key = next();
+    for (auto &key : castlingZobrist)
+        key = next();
+    for (auto &key : enPassantZobrist)
+        key = next();
+    sideZobrist = next();
+    return true;
+}
+
+static const bool zobristReady = initZobrist();
+
 board::board(const std::string &initialFen) : fen(initialFen)
 {
     reset();
@@ -13,6 +58,8 @@ void board::reset()
 void board::setFromFEN(const std::string &newFen)
 {
     fen = newFen;
+    pieceKey = 0;
+    pawnKey = 0;
 
     for (int row = 0; row < 8; ++row)
     {
@@ -23,8 +70,8 @@ void board::setFromFEN(const std::string &newFen)
     }
 
     std::istringstream fenStream(newFen);
-    std::string boardPart;
-    fenStream >> boardPart;
+    std::string boardPart, sidePart, castlingPart, enPassantPart;
+    fenStream >> boardPart >> sidePart >> castlingPart >> enPassantPart;
 
     int row = 7;
     int col = 0;
@@ -44,147 +91,217 @@ void board::setFromFEN(const std::string &newFen)
         {
             if (col < 8)
             {
-                boardState[row][col] = c;
+                putPiece(row, col, c);
                 col++;
             }
         }
     }
+
+    // A missing right is recorded as if that rook had already moved.
+    whiteKingMoved = blackKingMoved = false;
+    whiteRookMoved[0] = castlingPart.find('Q') == std::string::npos;
+    whiteRookMoved[1] = castlingPart.find('K') == std::string::npos;
+    blackRookMoved[0] = castlingPart.find('q') == std::string::npos;
+    blackRookMoved[1] = castlingPart.find('k') == std::string::npos;
+
+    activeSide = sidePart == "b" ? 'b' : 'w';
+
+    enPassantTarget = {-1, -1};
+    if (enPassantPart.size() == 2 && enPassantPart[0] >= 'a' && enPassantPart[0] <= 'h' &&
+        (enPassantPart[1] == '3' || enPassantPart[1] == '6'))
+    {
+        enPassantTarget = {enPassantPart[1] - '1', enPassantPart[0] - 'a'};
+    }
 }
 
-static bool whiteKingMoved = false, blackKingMoved = false;
-static bool whiteRookMoved[2] = {false, false}; // [queen-side, king-side]
-static bool blackRookMoved[2] = {false, false};
-void board::applyMoves(const std::vector<std::string> &moves)
+void board::setPosition(const char squares[64], char side, int rights, int enPassantCol)
+{
+    fen.clear();
+    pieceKey = 0;
+    pawnKey = 0;
+
+    for (int square = 0; square < 64; ++square)
+    {
+        boardState[square / 8][square % 8] = '\0';
+        if (squares[square] != '\0')
+            putPiece(square / 8, square % 8, squares[square]);
+    }
+
+    activeSide = side;
+    whiteKingMoved = blackKingMoved = false;
+    whiteRookMoved[1] = !(rights & 1);
+    whiteRookMoved[0] = !(rights & 2);
+    blackRookMoved[1] = !(rights & 4);
+    blackRookMoved[0] = !(rights & 8);
+
+    enPassantTarget = {-1, -1};
+    if (enPassantCol >= 0 && enPassantCol < 8)
+        enPassantTarget = {side == 'w' ? 5 : 2, enPassantCol};
+}
+
+void board::putPiece(int row, int col, char piece)
+{
+    char old = boardState[row][col];
+    int square = row * 8 + col;
+
+    if (old != '\0')
+    {
+        pieceKey ^= pieceZobrist[zobristIndex(old)][square];
+        if (old == 'P' || old == 'p')
+            pawnKey ^= pieceZobrist[zobristIndex(old)][square];
+    }
+    if (piece != '\0')
+    {
+        pieceKey ^= pieceZobrist[zobristIndex(piece)][square];
+        if (piece == 'P' || piece == 'p')
+            pawnKey ^= pieceZobrist[zobristIndex(piece)][square];
+    }
+    boardState[row][col] = piece;
+}
+
+int board::castlingRights() const
+{
+    int rights = 0;
+    if (!whiteKingMoved && !whiteRookMoved[1])
+        rights |= 1;
+    if (!whiteKingMoved && !whiteRookMoved[0])
+        rights |= 2;
+    if (!blackKingMoved && !blackRookMoved[1])
+        rights |= 4;
+    if (!blackKingMoved && !blackRookMoved[0])
+        rights |= 8;
+    return rights;
+}
+
+uint64_t board::hashKey(char player) const
 {
-    static std::pair<int, int> enPassantTarget = {-1, -1}; 
+    uint64_t key = pieceKey;
+    int rights = castlingRights();
 
+    for (int i = 0; i < 4; ++i)
+    {
+        if (rights & (1 << i))
+            key ^= castlingZobrist[i];
+    }
+    if (enPassantTarget.second >= 0)
+        key ^= enPassantZobrist[enPassantTarget.second];
+    if (player == 'b')
+        key ^= sideZobrist;
+
+    return key;
+}
+
+void board::applyMoves(const std::vector<std::string> &moves)
+{
     for (const auto &move : moves)
     {
-        if (move.size() < 4)
-        {
-            std::cerr << "Invalid move format: " << move << "\n";
-            continue;
-        }
+        applyMove(move);
+    }
+}
 
-        int fromCol = move[0] - 'a';
-        int fromRow = move[1] - '1';
-        int toCol = move[2] - 'a';
-        int toRow = move[3] - '1';
+void board::applyMove(const std::string &move)
+{
+    if (move.size() < 4)
+    {
+        std::cerr << "Invalid move format: " << move << "\n";
+        return;
+    }
 
-        if (fromCol < 0 || fromCol > 7 || fromRow < 0 || fromRow > 7 ||
-            toCol < 0 || toCol > 7 || toRow < 0 || toRow > 7)
-        {
-            std::cerr << "Move out of bounds: " << move << "\n";
-            continue;
-        }
+    int fromCol = move[0] - 'a';
+    int fromRow = move[1] - '1';
+    int toCol = move[2] - 'a';
+    int toRow = move[3] - '1';
 
-        char piece = boardState[fromRow][fromCol];
-        boardState[fromRow][fromCol] = '\0';
+    if (fromCol < 0 || fromCol > 7 || fromRow < 0 || fromRow > 7 ||
+        toCol < 0 || toCol > 7 || toRow < 0 || toRow > 7)
+    {
+        std::cerr << "Move out of bounds: " << move << "\n";
+        return;
+    }
 
-        // Handle promotion
-        if (move.size() == 5)
-        {
-            char promotionPiece = move[4]; 
-            if (piece == 'P' && toRow == 7) 
-            {
-                piece = std::toupper(promotionPiece);
-            }
-            else if (piece == 'p' && toRow == 0) 
-            {
-                piece = std::tolower(promotionPiece); 
-            }
-        }
+    char piece = boardState[fromRow][fromCol];
+    putPiece(fromRow, fromCol, '\0');
 
-        // Handle en passant capture
-        if (piece == 'P' || piece == 'p')
+    // Handle promotion
+    if (move.size() == 5)
+    {
+        char promotionPiece = move[4];
+        if (piece == 'P' && toRow == 7)
         {
-            if (toCol != fromCol && boardState[toRow][toCol] == '\0')
-            {
-                if (piece == 'P' && toRow == fromRow + 1 && enPassantTarget == std::make_pair(toRow - 1, toCol))
-                {
-                    boardState[toRow - 1][toCol] = '\0'; 
-                }
-                if (piece == 'p' && toRow == fromRow - 1 && enPassantTarget == std::make_pair(toRow + 1, toCol))
-                {
-                    boardState[toRow + 1][toCol] = '\0'; 
-                }
-            }
-            // Set en passant target if pawn moves two squares forward
-            if (abs(fromRow - toRow) == 2)
-            {
-                enPassantTarget = {fromRow + (toRow - fromRow) / 2, toCol};
-            }
-            else
-            {
-                enPassantTarget = {-1, -1};
-            }
+            piece = std::toupper(promotionPiece);
         }
-        else
+        else if (piece == 'p' && toRow == 0)
         {
-            enPassantTarget = {-1, -1}; // Reset en passant target if not a pawn move
+            piece = std::tolower(promotionPiece);
         }
+    }
 
-        // Handle castling
-        if (piece == 'K' && abs(fromCol - toCol) == 2)
+    // Handle en passant capture
+    if (piece == 'P' || piece == 'p')
+    {
+        if (toCol != fromCol && boardState[toRow][toCol] == '\0' &&
+            enPassantTarget == std::make_pair(toRow, toCol))
         {
-            if (toCol == 6)
-            {                                        
-                boardState[0][5] = boardState[0][7]; 
-                boardState[0][7] = '\0';
-            }
-            else if (toCol == 2)
-            {                                        
-                boardState[0][3] = boardState[0][0]; 
-                boardState[0][0] = '\0';
-            }
-            whiteKingMoved = true;
+            putPiece(fromRow, toCol, '\0');
         }
-        else if (piece == 'k' && abs(fromCol - toCol) == 2)
+        // Set en passant target if pawn moves two squares forward
+        if (abs(fromRow - toRow) == 2)
         {
-            if (toCol == 6)
-            {                                       
-                boardState[7][5] = boardState[7][7]; 
-                boardState[7][7] = '\0';
-            }
-            else if (toCol == 2)
-            {                                        
-                boardState[7][3] = boardState[7][0]; 
-                boardState[7][0] = '\0';
-            }
-            blackKingMoved = true;
+            enPassantTarget = {fromRow + (toRow - fromRow) / 2, toCol};
         }
+        else
+        {
+            enPassantTarget = {-1, -1};
+        }
+    }
+    else
+    {
+        enPassantTarget = {-1, -1}; // Reset en passant target if not a pawn move
+    }
 
-        // Track rook moves for castling rights
-        if (piece == 'R')
+    // Handle castling
+    if (piece == 'K')
+    {
+        if (abs(fromCol - toCol) == 2 && toCol == 6)
         {
-            if (fromRow == 7 && fromCol == 0)
-                whiteRookMoved[0] = true;
-            if (fromRow == 7 && fromCol == 7)
-                whiteRookMoved[1] = true;
+            putPiece(0, 5, boardState[0][7]);
+            putPiece(0, 7, '\0');
         }
-        else if (piece == 'r')
+        else if (abs(fromCol - toCol) == 2 && toCol == 2)
         {
-            if (fromRow == 0 && fromCol == 0)
-                blackRookMoved[0] = true;
-            if (fromRow == 0 && fromCol == 7)
-                blackRookMoved[1] = true;
+            putPiece(0, 3, boardState[0][0]);
+            putPiece(0, 0, '\0');
         }
-
-        // Update the destination square
-        boardState[toRow][toCol] = piece;
+        whiteKingMoved = true;
     }
-}
-
-std::string board::getBestMove(char player)
-{
-    std::vector<std::string> legalMoves = generateLegalMoves(player);
-
-    if (legalMoves.empty())
+    else if (piece == 'k')
     {
-        return "0000";
+        if (abs(fromCol - toCol) == 2 && toCol == 6)
+        {
+            putPiece(7, 5, boardState[7][7]);
+            putPiece(7, 7, '\0');
+        }
+        else if (abs(fromCol - toCol) == 2 && toCol == 2)
+        {
+            putPiece(7, 3, boardState[7][0]);
+            putPiece(7, 0, '\0');
+        }
+        blackKingMoved = true;
     }
 
-    return legalMoves[std::rand() % legalMoves.size()];
+    // A rook leaving or being captured on its home square loses the right
+    if ((fromRow == 0 && fromCol == 0) || (toRow == 0 && toCol == 0))
+        whiteRookMoved[0] = true;
+    if ((fromRow == 0 && fromCol == 7) || (toRow == 0 && toCol == 7))
+        whiteRookMoved[1] = true;
+    if ((fromRow == 7 && fromCol == 0) || (toRow == 7 && toCol == 0))
+        blackRookMoved[0] = true;
+    if ((fromRow == 7 && fromCol == 7) || (toRow == 7 && toCol == 7))
+        blackRookMoved[1] = true;
+
+    // Update the destination square
+    putPiece(toRow, toCol, piece);
+    activeSide = activeSide == 'w' ? 'b' : 'w';
 }
 
 std::vector<std::string> board::generateLegalMoves(char player) const
@@ -206,7 +323,7 @@ std::vector<std::string> board::generateLegalMoves(char player) const
                 for (const auto &move : pieceMoves)
                 {
                     board testBoard = *this;
-                    testBoard.applyMoves({move});
+                    testBoard.applyMove(move);
                     if (!testBoard.isKingInCheck(player))
                     {
                         moves.push_back(move);
@@ -244,50 +361,58 @@ bool board::isKingInCheck(char player) const
     }
 
     char opponent = (player == 'w') ? 'b' : 'w';
+    return isSquareAttacked(kingRow, kingCol, opponent);
+}
 
-    if (player == 'w')
+bool board::isSquareAttacked(int row, int col, char opponent) const
+{
+    // Look outwards from the square rather than generating the opponent's
+    // moves: cheaper, and castling checks can't recurse into each other.
+    if (opponent == 'b')
     {
-        if (kingRow < 7 && kingCol > 0 && boardState[kingRow + 1][kingCol - 1] == 'p')
+        if (row < 7 && col > 0 && boardState[row + 1][col - 1] == 'p')
             return true;
-        if (kingRow < 7 && kingCol < 7 && boardState[kingRow + 1][kingCol + 1] == 'p')
+        if (row < 7 && col < 7 && boardState[row + 1][col + 1] == 'p')
             return true;
     }
     else
     {
-        if (kingRow > 0 && kingCol > 0 && boardState[kingRow - 1][kingCol - 1] == 'P')
+        if (row > 0 && col > 0 && boardState[row - 1][col - 1] == 'P')
             return true;
-        if (kingRow > 0 && kingCol < 7 && boardState[kingRow - 1][kingCol + 1] == 'P')
+        if (row > 0 && col < 7 && boardState[row - 1][col + 1] == 'P')
             return true;
     }
 
-    const std::vector<std::pair<int, int>> knightMoves = {{2, 1}, {2, -1}, {1, 2}, {1, -2}, {-2, 1}, {-2, -1}, {-1, 2}, {-1, -2}};
+    static const std::pair<int, int> knightMoves[] = {{2, 1}, {2, -1}, {1, 2}, {1, -2}, {-2, 1}, {-2, -1}, {-1, 2}, {-1, -2}};
+    char knight = (opponent == 'w') ? 'N' : 'n';
     for (const auto &move : knightMoves)
     {
-        int r = kingRow + move.first;
-        int c = kingCol + move.second;
-        if (r >= 0 && r < 8 && c >= 0 && c < 8)
-        {
-            char piece = boardState[r][c];
-            if ((player == 'w' && piece == 'n') || (player == 'b' && piece == 'N'))
-                return true;
-        }
+        int r = row + move.first;
+        int c = col + move.second;
+        if (r >= 0 && r < 8 && c >= 0 && c < 8 && boardState[r][c] == knight)
+            return true;
     }
 
-    const std::vector<std::pair<int, int>> directions = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    static const std::pair<int, int> directions[] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    char king = (opponent == 'w') ? 'K' : 'k';
     for (const auto &dir : directions)
     {
-        int r = kingRow + dir.first;
-        int c = kingCol + dir.second;
+        int r = row + dir.first;
+        int c = col + dir.second;
+        if (r >= 0 && r < 8 && c >= 0 && c < 8 && boardState[r][c] == king)
+            return true;
+
         while (r >= 0 && r < 8 && c >= 0 && c < 8)
         {
             char piece = boardState[r][c];
             if (piece != '\0')
             {
-                if ((player == 'w' && std::islower(piece)) || (player == 'b' && std::isupper(piece)))
+                if ((opponent == 'w' && std::isupper(piece)) || (opponent == 'b' && std::islower(piece)))
                 {
-                    if ((dir.first == 0 || dir.second == 0) && (piece == 'r' || piece == 'R' || piece == 'q' || piece == 'Q'))
+                    char type = std::tolower(piece);
+                    if ((dir.first == 0 || dir.second == 0) && (type == 'r' || type == 'q'))
                         return true;
-                    if ((dir.first != 0 && dir.second != 0) && (piece == 'b' || piece == 'B' || piece == 'q' || piece == 'Q'))
+                    if ((dir.first != 0 && dir.second != 0) && (type == 'b' || type == 'q'))
                         return true;
                 }
                 break;
@@ -297,44 +422,6 @@ bool board::isKingInCheck(char player) const
         }
     }
 
-    const std::vector<std::pair<int, int>> kingMoves = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
-    for (const auto &move : kingMoves)
-    {
-        int r = kingRow + move.first;
-        int c = kingCol + move.second;
-        if (r >= 0 && r < 8 && c >= 0 && c < 8)
-        {
-            char piece = boardState[r][c];
-            if ((player == 'w' && piece == 'k') || (player == 'b' && piece == 'K'))
-                return true;
-        }
-    }
-
-    return false;
-}
-
-bool board::isSquareAttacked(int row, int col, char opponent) const
-{
-    for (int r = 0; r < 8; ++r)
-    {
-        for (int c = 0; c < 8; ++c)
-        {
-            char piece = boardState[r][c];
-            if ((opponent == 'w' && std::isupper(piece)) || (opponent == 'b' && std::islower(piece)))
-            {
-                std::vector<std::string> opponentMoves = generateMovesForPiece(r, c, piece);
-                for (const auto &move : opponentMoves)
-                {
-                    int targetRow = move[2] - '1';
-                    int targetCol = move[3] - 'a';
-                    if (targetRow == row && targetCol == col)
-                    {
-                        return true;
-                    }
-                }
-            }
-        }
-    }
     return false;
 }
 
@@ -342,13 +429,11 @@ std::vector<std::string> board::generateMovesForPiece(int row, int col, char pie
 {
     std::vector<std::string> moves;
 
-    const std::vector<std::pair<int, int>> rookDirections = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
-    const std::vector<std::pair<int, int>> bishopDirections = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
-    const std::vector<std::pair<int, int>> queenDirections = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
-    const std::vector<std::pair<int, int>> knightMoves = {{2, 1}, {2, -1}, {1, 2}, {1, -2}, {-2, 1}, {-2, -1}, {-1, 2}, {-1, -2}};
-    const std::vector<std::pair<int, int>> kingMoves = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
-
-    static std::pair<int, int> enPassantTarget = {-1, -1};
+    static const std::vector<std::pair<int, int>> rookDirections = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    static const std::vector<std::pair<int, int>> bishopDirections = {{1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    static const std::vector<std::pair<int, int>> queenDirections = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
+    static const std::vector<std::pair<int, int>> knightMoves = {{2, 1}, {2, -1}, {1, 2}, {1, -2}, {-2, 1}, {-2, -1}, {-1, 2}, {-1, -2}};
+    static const std::vector<std::pair<int, int>> kingMoves = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}, {1, 1}, {1, -1}, {-1, 1}, {-1, -1}};
 
     if (piece == 'P')
     {
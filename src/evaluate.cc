@@ -0,0 +1,280 @@
+#include "evaluate.h"
+#include <cctype>
+#include <cstring>
+
+int evalParams[EVAL_PARAM_COUNT] = {
+    100, // PAWN_VALUE
+    320, // KNIGHT_VALUE
+    330, // BISHOP_VALUE
+    500, // ROOK_VALUE
+    900, // QUEEN_VALUE
+    5,   // PAWN_ADVANCE
+    10,  // KNIGHT_CENTRE
+    5,   // BISHOP_CENTRE
+    2,   // QUEEN_CENTRE
+    -10, // KING_CENTRE
+    30,  // BISHOP_PAIR
+    15,  // ROOK_SEMI_OPEN_FILE
+    10,  // PASSED_PAWN
+    10,  // PASSED_PAWN_RANK
+    -15, // DOUBLED_PAWN
+    -12, // ISOLATED_PAWN
+    -8,  // BACKWARD_PAWN
+    10,  // PAWN_SHIELD
+    -6,  // PAWN_STORM
+};
+
+const char *evalParamNames[EVAL_PARAM_COUNT] = {
+    "PAWN_VALUE", "KNIGHT_VALUE", "BISHOP_VALUE", "ROOK_VALUE", "QUEEN_VALUE",
+    "PAWN_ADVANCE", "KNIGHT_CENTRE", "BISHOP_CENTRE", "QUEEN_CENTRE", "KING_CENTRE",
+    "BISHOP_PAIR", "ROOK_SEMI_OPEN_FILE", "PASSED_PAWN", "PASSED_PAWN_RANK", "DOUBLED_PAWN",
+    "ISOLATED_PAWN", "BACKWARD_PAWN", "PAWN_SHIELD", "PAWN_STORM",
+};
+
+// 32K entries of 48 bytes: a little over 1.5MB per thread.
+static const size_t pawnTableSize = 1 << 15;
+
+static uint64_t fileBB(int file)
+{
+    return 0x0101010101010101ULL << file;
+}
+
+static uint64_t rankBB(int rank)
+{
+    return 0xFFULL << (rank * 8);
+}
+
+static uint64_t adjacentFilesBB(int file)
+{
+    return (file > 0 ? fileBB(file - 1) : 0) | (file < 7 ? fileBB(file + 1) : 0);
+}
+
+static uint64_t ranksAbove(int rank)
+{
+    return rank >= 7 ? 0 : ~0ULL << ((rank + 1) * 8);
+}
+
+// Counts pawn-structure features for the side owning `own`. Both
+// bitboards are oriented so that this side's pawns move up the board.
+static void countPawnTerms(uint64_t own, uint64_t enemy, int counts[EVAL_PARAM_COUNT],
+                           uint8_t &semiOpen, uint8_t shield[8], uint8_t storm[8])
+{
+    for (uint64_t pawns = own; pawns; pawns &= pawns - 1)
+    {
+        int square = __builtin_ctzll(pawns);
+        int rank = square / 8;
+        int file = square % 8;
+        uint64_t adjacent = adjacentFilesBB(file);
+
+        if (!(enemy & (fileBB(file) | adjacent) & ranksAbove(rank)))
+        {
+            counts[PASSED_PAWN]++;
+            counts[PASSED_PAWN_RANK] += rank - 1;
+        }
+        if (own & fileBB(file) & ranksAbove(rank))
+        {
+            counts[DOUBLED_PAWN]++;
+        }
+        if (!(own & adjacent))
+        {
+            counts[ISOLATED_PAWN]++;
+        }
+        else if (!(own & adjacent & ~ranksAbove(rank)) && rank < 6 &&
+                 (enemy & adjacent & rankBB(rank + 2)))
+        {
+            // Nothing beside or behind can support it and the square in
+            // front is held by an enemy pawn.
+            counts[BACKWARD_PAWN]++;
+        }
+    }
+
+    semiOpen = 0;
+    for (int file = 0; file < 8; ++file)
+    {
+        if (!(own & fileBB(file)))
+            semiOpen |= 1 << file;
+
+        uint64_t zone = fileBB(file) | adjacentFilesBB(file);
+        shield[file] = __builtin_popcountll(own & zone & (rankBB(1) | rankBB(2)));
+        storm[file] = __builtin_popcountll(enemy & zone & (rankBB(2) | rankBB(3) | rankBB(4)));
+    }
+}
+
+// When `coefficients` is set, the pawn-term counts (white minus black)
+// are added to it as well.
+static void computePawnEntry(const board &position, pawnEntry &entry, int *coefficients)
+{
+    uint64_t whitePawns = 0, blackPawns = 0;
+    for (int row = 0; row < 8; ++row)
+    {
+        for (int col = 0; col < 8; ++col)
+        {
+            char piece = position.pieceAt(row, col);
+            if (piece == 'P')
+                whitePawns |= 1ULL << (row * 8 + col);
+            else if (piece == 'p')
+                blackPawns |= 1ULL << (row * 8 + col);
+        }
+    }
+
+    int whiteCounts[EVAL_PARAM_COUNT] = {};
+    int blackCounts[EVAL_PARAM_COUNT] = {};
+    countPawnTerms(whitePawns, blackPawns, whiteCounts, entry.semiOpen[0], entry.shield[0], entry.storm[0]);
+    countPawnTerms(__builtin_bswap64(blackPawns), __builtin_bswap64(whitePawns), blackCounts,
+                   entry.semiOpen[1], entry.shield[1], entry.storm[1]);
+
+    int score = 0;
+    for (int param : {PASSED_PAWN, PASSED_PAWN_RANK, DOUBLED_PAWN, ISOLATED_PAWN, BACKWARD_PAWN})
+    {
+        score += evalParams[param] * (whiteCounts[param] - blackCounts[param]);
+        if (coefficients)
+            coefficients[param] += whiteCounts[param] - blackCounts[param];
+    }
+
+    entry.key = position.pawnHashKey();
+    entry.score = static_cast<int16_t>(score);
+}
+
+pawnHashTable::pawnHashTable() : probes(0), hits(0)
+{
+    table = static_cast<pawnEntry *>(allocateLarge(pawnTableSize * sizeof(pawnEntry), pageInfo));
+    clear();
+}
+
+pawnHashTable::~pawnHashTable()
+{
+    freeLarge(table, pageInfo);
+}
+
+void pawnHashTable::clear()
+{
+    if (!table)
+        return;
+
+    std::memset(static_cast<void *>(table), 0, pawnTableSize * sizeof(pawnEntry));
+    // Key 0 is a real position (no pawns), so mark empty slots otherwise.
+    for (size_t i = 0; i < pawnTableSize; ++i)
+    {
+        table[i].key = ~0ULL;
+    }
+}
+
+const pawnEntry &pawnHashTable::probe(const board &position)
+{
+    static thread_local pawnEntry scratch;
+    uint64_t key = position.pawnHashKey();
+    pawnEntry &entry = table ? table[key & (pawnTableSize - 1)] : scratch;
+
+    probes++;
+    if (table && entry.key == key)
+    {
+        hits++;
+        return entry;
+    }
+
+    computePawnEntry(position, entry, nullptr);
+    return entry;
+}
+
+double pawnHashTable::hitRate() const
+{
+    return probes ? 100.0 * hits / probes : 0.0;
+}
+
+// 3 on the four centre squares down to 0 on the rim.
+static int centrality(int row, int col)
+{
+    int rowDistance = row < 4 ? 3 - row : row - 4;
+    int colDistance = col < 4 ? 3 - col : col - 4;
+    return 3 - (rowDistance > colDistance ? rowDistance : colDistance);
+}
+
+// Everything but the cached pawn terms. Each term adds weight * count
+// to the score and, when tracing, the count to `coefficients`.
+static int evaluatePieces(const board &position, const pawnEntry &entry, int *coefficients)
+{
+    int score = 0;
+    int bishops[2] = {0, 0};
+    int sign = 1;
+
+    auto add = [&score, &sign, coefficients](int param, int count)
+    {
+        score += sign * evalParams[param] * count;
+        if (coefficients)
+            coefficients[param] += sign * count;
+    };
+
+    for (int row = 0; row < 8; ++row)
+    {
+        for (int col = 0; col < 8; ++col)
+        {
+            char piece = position.pieceAt(row, col);
+            if (piece == '\0')
+                continue;
+
+            int side = std::isupper(piece) ? 0 : 1;
+            int relativeRank = side == 0 ? row : 7 - row;
+            int centre = centrality(row, col);
+            sign = side == 0 ? 1 : -1;
+
+            switch (std::tolower(piece))
+            {
+            case 'p':
+                add(PAWN_VALUE, 1);
+                add(PAWN_ADVANCE, relativeRank - 1);
+                break;
+            case 'n':
+                add(KNIGHT_VALUE, 1);
+                add(KNIGHT_CENTRE, centre);
+                break;
+            case 'b':
+                add(BISHOP_VALUE, 1);
+                add(BISHOP_CENTRE, centre);
+                bishops[side]++;
+                break;
+            case 'r':
+                add(ROOK_VALUE, 1);
+                if (entry.semiOpen[side] & (1 << col))
+                    add(ROOK_SEMI_OPEN_FILE, 1);
+                break;
+            case 'q':
+                add(QUEEN_VALUE, 1);
+                add(QUEEN_CENTRE, centre);
+                break;
+            case 'k':
+                add(KING_CENTRE, centre);
+                if (relativeRank <= 1)
+                {
+                    add(PAWN_SHIELD, entry.shield[side][col]);
+                    add(PAWN_STORM, entry.storm[side][col]);
+                }
+                break;
+            }
+        }
+    }
+
+    sign = 1;
+    if (bishops[0] >= 2)
+        add(BISHOP_PAIR, 1);
+    sign = -1;
+    if (bishops[1] >= 2)
+        add(BISHOP_PAIR, 1);
+
+    return score;
+}
+
+int evaluate(const board &position, pawnHashTable &pawns)
+{
+    const pawnEntry &entry = pawns.probe(position);
+    return entry.score + evaluatePieces(position, entry, nullptr);
+}
+
+void traceEvaluation(const board &position, int coefficients[EVAL_PARAM_COUNT])
+{
+    for (int i = 0; i < EVAL_PARAM_COUNT; ++i)
+        coefficients[i] = 0;
+
+    pawnEntry entry;
+    computePawnEntry(position, entry, coefficients);
+    evaluatePieces(position, entry, coefficients);
+}
@@ -0,0 +1,193 @@
+#include "large_pages.h"
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const size_t hugePageSize = 2 * 1024 * 1024;
+static const size_t cacheLineSize = 64;
+
+static size_t roundUp(size_t bytes, size_t alignment)
+{
+    return (bytes + alignment - 1) / alignment * alignment;
+}
+
+#if defined(__linux__)
+// Walks /proc/self/smaps to the mapping that contains `ptr` and returns
+// the largest page size (in KB) backing it, or 0 if it cannot be read.
+static size_t backingPageKb(const void *ptr)
+{
+    std::ifstream smaps("/proc/self/smaps");
+    std::string line;
+    uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+    bool inRegion = false;
+    size_t pageKb = 0;
+
+    while (std::getline(smaps, line))
+    {
+        size_t dash = line.find('-');
+        size_t space = line.find(' ');
+        if (dash != std::string::npos && dash < space)
+        {
+            if (inRegion)
+                break;
+            uintptr_t start = std::strtoull(line.substr(0, dash).c_str(), nullptr, 16);
+            uintptr_t end = std::strtoull(line.substr(dash + 1, space - dash - 1).c_str(), nullptr, 16);
+            inRegion = addr >= start && addr < end;
+            continue;
+        }
+        if (!inRegion)
+            continue;
+
+        std::istringstream fields(line);
+        std::string name;
+        size_t kb = 0;
+        fields >> name >> kb;
+        if (name == "KernelPageSize:" && kb > pageKb)
+            pageKb = kb;
+        else if (name == "AnonHugePages:" && kb > 0 && hugePageSize / 1024 > pageKb)
+            pageKb = hugePageSize / 1024;
+    }
+    return pageKb;
+}
+
+// NUMA node of the page holding `ptr`, or -1 if the kernel won't say.
+static int backingNode(const void *ptr)
+{
+#if defined(SYS_get_mempolicy)
+    const unsigned long policyFlags = 1 | 2; // MPOL_F_NODE | MPOL_F_ADDR
+    int node = -1;
+    if (syscall(SYS_get_mempolicy, &node, nullptr, 0, ptr, policyFlags) == 0)
+        return node;
+#else
+    (void)ptr;
+#endif
+    return -1;
+}
+
+// Expands a sysfs list such as "0-15,32-47" into its members.
+static std::vector<int> readSysList(const std::string &path)
+{
+    std::vector<int> members;
+    std::ifstream file(path);
+    std::string range;
+    while (std::getline(file, range, ','))
+    {
+        size_t dash = range.find('-');
+        int first = std::atoi(range.c_str());
+        int last = dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+        for (int member = first; member <= last; ++member)
+            members.push_back(member);
+    }
+    return members;
+}
+#endif
+
+void *allocateLarge(size_t bytes, largePageInfo &info)
+{
+    info = largePageInfo();
+    info.requestedBytes = bytes;
+
+#if defined(__linux__)
+    if (bytes >= hugePageSize)
+    {
+        size_t mapped = roundUp(bytes, hugePageSize);
+
+        // Explicit huge pages only work if the admin reserved some
+        // (vm.nr_hugepages); most machines will fall through.
+        void *mem = mmap(nullptr, mapped, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (mem != MAP_FAILED)
+        {
+            info.mappedBytes = mapped;
+            info.hugetlb = true;
+            return mem;
+        }
+
+        mem = std::aligned_alloc(hugePageSize, mapped);
+        if (mem)
+        {
+            info.mappedBytes = mapped;
+            info.madvised = madvise(mem, mapped, MADV_HUGEPAGE) == 0;
+            return mem;
+        }
+    }
+#endif
+
+    size_t mapped = roundUp(bytes, cacheLineSize);
+    void *mem = std::aligned_alloc(cacheLineSize, mapped);
+    if (mem)
+        info.mappedBytes = mapped;
+    return mem;
+}
+
+void freeLarge(void *ptr, const largePageInfo &info)
+{
+    if (!ptr)
+        return;
+#if defined(__linux__)
+    if (info.hugetlb)
+    {
+        munmap(ptr, info.mappedBytes);
+        return;
+    }
+#endif
+    std::free(ptr);
+}
+
+std::string describeLarge(const void *ptr, const largePageInfo &info)
+{
+    std::ostringstream out;
+    const char *method = info.hugetlb ? "hugetlbfs" : info.madvised ? "transparent huge pages" : "default allocator";
+
+#if defined(__linux__)
+    size_t pageKb = ptr ? backingPageKb(ptr) : 0;
+    if (pageKb == 0)
+        pageKb = static_cast<size_t>(sysconf(_SC_PAGESIZE)) / 1024;
+    out << pageKb << " KB pages (" << method << ")";
+
+    int node = ptr ? backingNode(ptr) : -1;
+    if (node >= 0)
+        out << ", node " << node;
+#else
+    (void)ptr;
+    out << method;
+#endif
+    return out.str();
+}
+
+bool pinThreadToNode(int index)
+{
+#if defined(__linux__)
+    std::vector<int> nodes = readSysList("/sys/devices/system/node/online");
+    if (nodes.size() < 2)
+        return false;
+
+    int node = nodes[index % nodes.size()];
+    std::vector<int> cpus = readSysList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    if (cpus.empty())
+        return false;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus)
+    {
+        if (cpu >= 0 && cpu < CPU_SETSIZE)
+            CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)index;
+    return false;
+#endif
+}
@@ -1,6 +1,22 @@
 #include "uci_loop.h"
+#include "selfplay.h"
+#include "tuner.h"
+#include <string>
+#include <vector>
+
+int main(int argc, char *argv[]) {
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    if (!args.empty()) {
+        std::vector<std::string> rest(args.begin() + 1, args.end());
+        if (args[0] == "selfplay")
+            return runSelfplay(rest);
+        if (args[0] == "datagen")
+            return runDatagen(rest);
+        if (args[0] == "tune")
+            return runTuner(rest);
+    }
 
-int main() {
     uciLoop();
     return 0;
 }
@@ -0,0 +1,158 @@
+#include "packed_position.h"
+#include <cstring>
+#include <iostream>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static const char packedPieces[] = "PNBRQKpnbrqk";
+
+// 64K records, 2MB, per write to disk.
+static const size_t writerBufferSize = 1 << 16;
+
+packedPosition packPosition(const board &position, char player, int score)
+{
+    packedPosition packed;
+    std::memset(&packed, 0, sizeof(packed));
+
+    int index = 0;
+    for (int square = 0; square < 64; ++square)
+    {
+        char piece = position.pieceAt(square / 8, square % 8);
+        if (piece == '\0')
+            continue;
+
+        const char *found = std::strchr(packedPieces, piece);
+        if (!found || index >= 32)
+            continue;
+
+        packed.occupancy |= 1ULL << square;
+        packed.pieces[index / 2] |= static_cast<uint8_t>((found - packedPieces) << (4 * (index % 2)));
+        index++;
+    }
+
+    packed.flags = static_cast<uint8_t>((player == 'b' ? 1 : 0) | (position.castlingRights() << 1));
+    packed.enPassant = static_cast<int8_t>(position.enPassantFile());
+    packed.score = static_cast<int16_t>(score);
+    return packed;
+}
+
+char unpackPosition(const packedPosition &packed, board &position)
+{
+    char squares[64] = {};
+    int index = 0;
+    for (int square = 0; square < 64; ++square)
+    {
+        if (packed.occupancy & (1ULL << square))
+        {
+            squares[square] = packedPieces[(packed.pieces[index / 2] >> (4 * (index % 2))) & 15];
+            index++;
+        }
+    }
+
+    char player = (packed.flags & 1) ? 'b' : 'w';
+    position.setPosition(squares, player, packed.flags >> 1, packed.enPassant);
+    return player;
+}
+
+packedWriter::packedWriter(const std::string &path) : written(0)
+{
+    file = std::fopen(path.c_str(), "ab");
+    if (!file)
+        std::cerr << "Cannot open " << path << " for writing\n";
+    buffer.reserve(writerBufferSize);
+}
+
+packedWriter::~packedWriter()
+{
+    flush();
+    if (file)
+        std::fclose(file);
+}
+
+void packedWriter::write(const std::vector<packedPosition> &positions)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &position : positions)
+    {
+        buffer.push_back(position);
+        if (buffer.size() == writerBufferSize)
+            flushLocked();
+    }
+}
+
+void packedWriter::flush()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    flushLocked();
+}
+
+void packedWriter::flushLocked()
+{
+    if (file && !buffer.empty())
+    {
+        written += std::fwrite(buffer.data(), sizeof(packedPosition), buffer.size(), file);
+        std::fflush(file);
+    }
+    buffer.clear();
+}
+
+packedFile::packedFile(const std::string &path) : records(nullptr), recordCount(0), mappedBytes(0), opened(false)
+{
+#if defined(__linux__)
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        std::cerr << "Cannot open " << path << "\n";
+        return;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size >= static_cast<off_t>(sizeof(packedPosition)))
+    {
+        mappedBytes = static_cast<size_t>(info.st_size);
+        void *mem = mmap(nullptr, mappedBytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mem != MAP_FAILED)
+        {
+            madvise(mem, mappedBytes, MADV_SEQUENTIAL);
+            records = static_cast<const packedPosition *>(mem);
+            recordCount = mappedBytes / sizeof(packedPosition);
+        }
+        else
+        {
+            mappedBytes = 0;
+            std::cerr << "Cannot map " << path << "\n";
+            close(fd);
+            return;
+        }
+    }
+    close(fd);
+    opened = true;
+#else
+    std::FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        std::cerr << "Cannot open " << path << "\n";
+        return;
+    }
+    packedPosition record;
+    while (std::fread(&record, sizeof(record), 1, file) == 1)
+        copy.push_back(record);
+    std::fclose(file);
+    records = copy.empty() ? nullptr : copy.data();
+    recordCount = copy.size();
+    opened = true;
+#endif
+}
+
+packedFile::~packedFile()
+{
+#if defined(__linux__)
+    if (mappedBytes)
+        munmap(const_cast<packedPosition *>(records), mappedBytes);
+#endif
+}
@@ -0,0 +1,407 @@
+#include "search.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Scores this close to MATE_SCORE are mates, stored relative to the node.
+static const int MATE_BOUND = MATE_SCORE - MAX_PLY;
+
+static char opponentOf(char player)
+{
+    return player == 'w' ? 'b' : 'w';
+}
+
+static int pieceValue(char piece)
+{
+    switch (std::tolower(piece))
+    {
+    case 'p':
+        return 1;
+    case 'n':
+    case 'b':
+        return 3;
+    case 'r':
+        return 5;
+    case 'q':
+        return 9;
+    case 'k':
+        return 20;
+    }
+    return 0;
+}
+
+// Captures, including en passant, and promotions.
+static bool isTactical(const board &position, const std::string &move)
+{
+    if (move.size() == 5)
+        return true;
+
+    int fromRow = move[1] - '1', fromCol = move[0] - 'a';
+    int toRow = move[3] - '1', toCol = move[2] - 'a';
+    if (position.pieceAt(toRow, toCol) != '\0')
+        return true;
+
+    char piece = position.pieceAt(fromRow, fromCol);
+    return (piece == 'P' || piece == 'p') && fromCol != toCol;
+}
+
+// Hash move first, then captures by most valuable victim / least
+// valuable attacker, then promotions, then quiet moves by history.
+static void orderMoves(const board &position, std::vector<std::string> &moves, uint16_t ttMove,
+                       const int (*history)[64])
+{
+    std::vector<std::pair<int, std::string>> scored;
+    scored.reserve(moves.size());
+
+    for (auto &move : moves)
+    {
+        int score = 0;
+        if (ttMove && encodeMove(move) == ttMove)
+        {
+            score = 1000000;
+        }
+        else if (isTactical(position, move))
+        {
+            char victim = position.pieceAt(move[3] - '1', move[2] - 'a');
+            char attacker = position.pieceAt(move[1] - '1', move[0] - 'a');
+            score = 10000 + 100 * (victim ? pieceValue(victim) : 1) - pieceValue(attacker);
+            if (move.size() == 5)
+                score += 100 * pieceValue(move[4]);
+        }
+        else if (history)
+        {
+            uint16_t encoded = encodeMove(move);
+            score = history[encoded & 63][(encoded >> 6) & 63];
+        }
+        scored.emplace_back(score, std::move(move));
+    }
+
+    std::stable_sort(scored.begin(), scored.end(),
+                     [](const std::pair<int, std::string> &a, const std::pair<int, std::string> &b)
+                     { return a.first > b.first; });
+
+    for (size_t i = 0; i < moves.size(); ++i)
+    {
+        moves[i] = std::move(scored[i].second);
+    }
+}
+
+static int scoreToTT(int score, int ply)
+{
+    if (score >= MATE_BOUND)
+        return score + ply;
+    if (score <= -MATE_BOUND)
+        return score - ply;
+    return score;
+}
+
+static int scoreFromTT(int score, int ply)
+{
+    if (score >= MATE_BOUND)
+        return score - ply;
+    if (score <= -MATE_BOUND)
+        return score + ply;
+    return score;
+}
+
+// History scores stay below the capture band of orderMoves.
+static const int HISTORY_MAX = 8000;
+
+searcher::searcher(transpositionTable &table)
+    : tt(table), stopped(false), nodes(0), nodeLimit(0), hasDeadline(false), multiPV(1), history()
+{
+}
+
+bool searcher::outOfBudget()
+{
+    if (stopped)
+        return true;
+
+    if (nodeLimit && nodes >= nodeLimit)
+        stopped = true;
+    else if (hasDeadline && (nodes & 255) == 0 && std::chrono::steady_clock::now() >= deadline)
+        stopped = true;
+
+    return stopped;
+}
+
+int searcher::quiescence(const board &position, char player, int ply, int alpha, int beta)
+{
+    nodes++;
+    if (outOfBudget())
+        return 0;
+
+    int standPat = evaluate(position, pawns);
+    if (player == 'b')
+        standPat = -standPat;
+
+    if (ply >= MAX_PLY - 1 || standPat >= beta)
+        return standPat;
+    if (standPat > alpha)
+        alpha = standPat;
+
+    std::vector<std::string> moves = position.generateLegalMoves(player);
+    moves.erase(std::remove_if(moves.begin(), moves.end(),
+                               [&position](const std::string &move)
+                               { return !isTactical(position, move); }),
+                moves.end());
+    orderMoves(position, moves, 0, nullptr);
+
+    for (const auto &move : moves)
+    {
+        board child = position;
+        child.applyMove(move);
+        int score = -quiescence(child, opponentOf(player), ply + 1, -beta, -alpha);
+        if (stopped)
+            return 0;
+
+        if (score >= beta)
+            return score;
+        if (score > alpha)
+            alpha = score;
+    }
+
+    return alpha;
+}
+
+int searcher::alphaBeta(const board &position, char player, int depth, int ply, int alpha, int beta)
+{
+    if (depth <= 0)
+        return quiescence(position, player, ply, alpha, beta);
+
+    nodes++;
+    if (outOfBudget())
+        return 0;
+
+    uint64_t key = position.hashKey(player);
+    uint16_t ttMove = 0;
+    ttEntry entry;
+    if (tt.probe(key, entry))
+    {
+        ttMove = entry.move;
+        if (ply > 0 && entry.depth >= depth)
+        {
+            int score = scoreFromTT(entry.score, ply);
+            if (entry.bound == BOUND_EXACT ||
+                (entry.bound == BOUND_LOWER && score >= beta) ||
+                (entry.bound == BOUND_UPPER && score <= alpha))
+            {
+                return score;
+            }
+        }
+    }
+
+    std::vector<std::string> moves = position.generateLegalMoves(player);
+    if (moves.empty())
+        return position.isKingInCheck(player) ? -MATE_SCORE + ply : 0;
+    if (ply >= MAX_PLY - 1)
+        return player == 'w' ? evaluate(position, pawns) : -evaluate(position, pawns);
+
+    if (ply == 0 && !rootExcluded.empty())
+    {
+        moves.erase(std::remove_if(moves.begin(), moves.end(),
+                                   [this](const std::string &move)
+                                   { return std::find(rootExcluded.begin(), rootExcluded.end(), move) != rootExcluded.end(); }),
+                    moves.end());
+    }
+
+    int side = player == 'w' ? 0 : 1;
+    orderMoves(position, moves, ttMove, history[side]);
+
+    // The root entry can be evicted mid-iteration, so don't rely on the
+    // table to put the previous best move first.
+    if (ply == 0)
+    {
+        auto first = std::find(moves.begin(), moves.end(), rootFirst);
+        if (first != moves.end())
+            std::rotate(moves.begin(), first, first + 1);
+    }
+
+    int originalAlpha = alpha;
+    int bestScore = -MATE_SCORE - 1;
+    uint16_t bestMove = 0;
+
+    for (const auto &move : moves)
+    {
+        board child = position;
+        child.applyMove(move);
+        int score = -alphaBeta(child, opponentOf(player), depth - 1, ply + 1, -beta, -alpha);
+        if (stopped)
+            return 0;
+
+        if (score > bestScore)
+        {
+            bestScore = score;
+            bestMove = encodeMove(move);
+            if (ply == 0)
+                rootBest = move;
+        }
+        if (score > alpha)
+            alpha = score;
+        if (alpha >= beta)
+        {
+            if (!isTactical(position, move))
+            {
+                uint16_t encoded = encodeMove(move);
+                int &entry = history[side][encoded & 63][(encoded >> 6) & 63];
+                entry += depth * depth;
+                if (entry > HISTORY_MAX)
+                {
+                    for (auto &from : history[side])
+                        for (auto &value : from)
+                            value /= 2;
+                }
+            }
+            break;
+        }
+    }
+
+    // A root search with moves left out doesn't describe the position.
+    if (ply == 0 && !rootExcluded.empty())
+        return bestScore;
+
+    uint8_t bound = bestScore >= beta ? BOUND_LOWER : bestScore > originalAlpha ? BOUND_EXACT : BOUND_UPPER;
+    tt.store(key, bestMove, scoreToTT(bestScore, ply), depth, bound);
+    return bestScore;
+}
+
+std::string searcher::principalVariation(const board &root, char player, const std::string &first, int depth) const
+{
+    std::string line = first;
+    board position = root;
+    position.applyMove(first);
+    player = opponentOf(player);
+
+    for (int i = 1; i < depth; ++i)
+    {
+        ttEntry entry;
+        if (!tt.probe(position.hashKey(player), entry) || !entry.move)
+            break;
+
+        std::string move = decodeMove(entry.move);
+        std::vector<std::string> legal = position.generateLegalMoves(player);
+        if (std::find(legal.begin(), legal.end(), move) == legal.end())
+            break;
+
+        line += " " + move;
+        position.applyMove(move);
+        player = opponentOf(player);
+    }
+    return line;
+}
+
+searchResult searcher::think(const board &root, char player, const searchLimits &limits, std::ostream *info)
+{
+    auto start = std::chrono::steady_clock::now();
+    nodes = 0;
+    nodeLimit = limits.nodes;
+
+    int budget = limits.movetime;
+    if (!budget)
+    {
+        int time = player == 'w' ? limits.wtime : limits.btime;
+        int increment = player == 'w' ? limits.winc : limits.binc;
+        if (time > 0)
+            budget = std::max(1, std::min(time / 30 + increment / 2, time / 2));
+    }
+    hasDeadline = budget > 0;
+    deadline = start + std::chrono::milliseconds(budget);
+    if (hasDeadline && limits.nps)
+    {
+        uint64_t budgetNodes = std::max<uint64_t>(1, limits.nps * budget / 1000);
+        nodeLimit = nodeLimit ? std::min(nodeLimit, budgetNodes) : budgetNodes;
+        hasDeadline = false;
+    }
+
+    // A bare `go` has nothing to stop it, so keep it shallow.
+    int maxDepth = limits.depth ? limits.depth : (budget > 0 || nodeLimit || limits.infinite ? MAX_PLY - 1 : 4);
+    maxDepth = std::min(maxDepth, MAX_PLY - 1);
+
+    for (auto &side : history)
+        for (auto &from : side)
+            for (auto &value : from)
+                value /= 2;
+
+    searchResult result;
+    std::vector<std::string> rootMoves = root.generateLegalMoves(player);
+    if (!rootMoves.empty())
+        result.bestMove = rootMoves[0];
+    int lines = std::min(multiPV, static_cast<int>(rootMoves.size()));
+
+    // Mate or stalemate: nothing to search, but `go infinite` still waits.
+    for (int depth = 1; depth <= maxDepth && !rootMoves.empty(); ++depth)
+    {
+        // Each line searches the root again without the moves already
+        // reported. The later lines run on a table and history warmed by
+        // the earlier ones, so they cost far less than a fresh search.
+        rootExcluded.clear();
+        rootFirst = result.bestMove;
+        int bestScore = 0;
+
+        for (int pv = 0; pv < lines; ++pv)
+        {
+            rootBest.clear();
+            int score = alphaBeta(root, player, depth, 0, -MATE_SCORE - 1, MATE_SCORE + 1);
+
+            // An interrupted iteration still searched the previous best
+            // move first, so whatever it preferred is at least as good.
+            if (pv == 0 && !rootBest.empty())
+                result.bestMove = rootBest;
+            if (stopped || rootBest.empty())
+                break;
+
+            if (pv == 0)
+            {
+                bestScore = score;
+                result.score = score;
+                result.depth = depth;
+            }
+
+            if (info)
+            {
+                auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                   std::chrono::steady_clock::now() - start)
+                                   .count();
+                std::ostringstream out;
+                out << "info depth " << depth;
+                if (multiPV > 1)
+                    out << " multipv " << pv + 1;
+                out << " score ";
+                if (std::abs(score) >= MATE_BOUND)
+                    out << "mate " << (score > 0 ? (MATE_SCORE - score + 1) / 2 : -(MATE_SCORE + score) / 2);
+                else
+                    out << "cp " << score;
+                out << " nodes " << nodes << " nps " << nodes * 1000 / (elapsed + 1)
+                    << " time " << elapsed << " pv " << principalVariation(root, player, rootBest, depth) << "\n";
+                *info << out.str() << std::flush;
+            }
+
+            rootExcluded.push_back(rootBest);
+        }
+        rootExcluded.clear();
+
+        if (stopped)
+            break;
+        if (std::abs(bestScore) >= MATE_BOUND && lines == 1 && !limits.infinite)
+            break;
+    }
+
+    // `go infinite` must not answer before it is told to stop.
+    while (limits.infinite && !stopped)
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+
+    result.nodes = nodes;
+    if (info)
+    {
+        std::ostringstream out;
+        out << "info string pawn hash hit rate " << std::fixed << std::setprecision(1)
+            << pawns.hitRate() << "%\n";
+        *info << out.str() << std::flush;
+    }
+    return result;
+}
@@ -0,0 +1,767 @@
+#include "selfplay.h"
+#include "chess_board.h"
+#include "large_pages.h"
+#include "packed_position.h"
+#include "search.h"
+#include "transposition_table.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <thread>
+
+static const char *startFen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// Used when no --openings file is given.
+static const char *defaultOpenings[] = {
+    "e2e4 e7e5 g1f3 b8c6",
+    "e2e4 c7c5 g1f3 d7d6",
+    "e2e4 e7e6 d2d4 d7d5",
+    "e2e4 c7c6 d2d4 d7d5",
+    "d2d4 d7d5 c2c4 e7e6",
+    "d2d4 g8f6 c2c4 g7g6",
+    "c2c4 e7e5 b1c3 g8f6",
+    "g1f3 d7d5 g2g3 g8f6",
+};
+
+// Adjudication: a side scoring worse than -resignScore for resignPlies
+// plies in a row (with the opponent agreeing) loses; a position within
+// drawScore for drawPlies plies after drawStartPly is drawn.
+static const int resignScore = 1000;
+static const int resignPlies = 6;
+static const int drawScore = 10;
+static const int drawPlies = 8;
+static const int drawStartPly = 80;
+static const int maxPlies = 600;
+
+struct engineConfig {
+    std::string name;
+    int hashMb = 4;
+    searchLimits limits;
+    int baseMs = 0; // clock for a tc=base+inc game
+    int incMs = 0;
+};
+
+struct opening {
+    std::string fen;
+    char player = 'w';
+    std::vector<std::string> moves;
+};
+
+struct gameRecord {
+    std::string result; // "1-0", "0-1" or "1/2-1/2"
+    std::string reason;
+    std::vector<std::string> san;
+    std::vector<packedPosition> samples; // searched positions, for datagen
+};
+
+static char opponentOf(char player)
+{
+    return player == 'w' ? 'b' : 'w';
+}
+
+static bool parseEngine(const std::string &spec, engineConfig &config)
+{
+    std::istringstream fields(spec);
+    std::string field;
+
+    while (std::getline(fields, field, ','))
+    {
+        size_t equals = field.find('=');
+        if (equals == std::string::npos)
+        {
+            std::cerr << "Expected key=value in engine spec: " << field << "\n";
+            return false;
+        }
+        std::string key = field.substr(0, equals);
+        std::string value = field.substr(equals + 1);
+
+        if (key == "name")
+            config.name = value;
+        else if (key == "hash")
+            config.hashMb = std::max(1, std::atoi(value.c_str()));
+        else if (key == "depth")
+            config.limits.depth = std::atoi(value.c_str());
+        else if (key == "nodes")
+            config.limits.nodes = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "movetime")
+            config.limits.movetime = std::atoi(value.c_str());
+        else if (key == "nps")
+            config.limits.nps = std::strtoull(value.c_str(), nullptr, 10);
+        else if (key == "tc")
+        {
+            size_t plus = value.find('+');
+            config.baseMs = static_cast<int>(std::atof(value.substr(0, plus).c_str()) * 1000);
+            if (plus != std::string::npos)
+                config.incMs = static_cast<int>(std::atof(value.substr(plus + 1).c_str()) * 1000);
+        }
+        else
+        {
+            std::cerr << "Unknown engine option: " << key << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool loadOpenings(const std::string &path, std::vector<opening> &openings)
+{
+    std::vector<std::string> lines;
+    if (path.empty())
+    {
+        lines.assign(std::begin(defaultOpenings), std::end(defaultOpenings));
+    }
+    else
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            std::cerr << "Cannot open openings file: " << path << "\n";
+            return false;
+        }
+        std::string line;
+        while (std::getline(file, line))
+        {
+            if (!line.empty() && line[0] != '#')
+                lines.push_back(line);
+        }
+    }
+
+    for (const auto &line : lines)
+    {
+        opening book;
+        if (line.find('/') != std::string::npos)
+        {
+            book.fen = line;
+            std::istringstream fen(line);
+            std::string placement, side;
+            fen >> placement >> side;
+            book.player = side == "b" ? 'b' : 'w';
+        }
+        else
+        {
+            book.fen = startFen;
+            std::istringstream moves(line);
+            std::string move;
+            while (moves >> move)
+                book.moves.push_back(move);
+        }
+        openings.push_back(book);
+    }
+
+    if (openings.empty())
+        std::cerr << "No openings found\n";
+    return !openings.empty();
+}
+
+static bool isCapture(const board &position, const std::string &move)
+{
+    if (position.pieceAt(move[3] - '1', move[2] - 'a') != '\0')
+        return true;
+    char piece = position.pieceAt(move[1] - '1', move[0] - 'a');
+    return (piece == 'P' || piece == 'p') && move[0] != move[2];
+}
+
+static std::string toSan(const board &position, char player, const std::string &move,
+                         const std::vector<std::string> &legal)
+{
+    int fromRow = move[1] - '1', fromCol = move[0] - 'a';
+    int toCol = move[2] - 'a';
+    char type = std::toupper(position.pieceAt(fromRow, fromCol));
+    bool capture = isCapture(position, move);
+    std::string san;
+
+    if (type == 'K' && std::abs(fromCol - toCol) == 2)
+    {
+        san = toCol == 6 ? "O-O" : "O-O-O";
+    }
+    else if (type == 'P')
+    {
+        if (capture)
+            san = std::string(1, move[0]) + "x";
+        san += move.substr(2, 2);
+        if (move.size() == 5)
+            san += std::string("=") + static_cast<char>(std::toupper(move[4]));
+    }
+    else
+    {
+        bool ambiguous = false, sameFile = false, sameRank = false;
+        for (const auto &other : legal)
+        {
+            if (other == move || other.compare(2, 2, move, 2, 2) != 0 ||
+                std::toupper(position.pieceAt(other[1] - '1', other[0] - 'a')) != type)
+                continue;
+            ambiguous = true;
+            sameFile = sameFile || other[0] == move[0];
+            sameRank = sameRank || other[1] == move[1];
+        }
+
+        san = type;
+        if (ambiguous && !sameFile)
+            san += move[0];
+        else if (ambiguous && !sameRank)
+            san += move[1];
+        else if (ambiguous)
+            san += move.substr(0, 2);
+        if (capture)
+            san += "x";
+        san += move.substr(2, 2);
+    }
+
+    board after = position;
+    after.applyMove(move);
+    char opponent = opponentOf(player);
+    if (after.isKingInCheck(opponent))
+        san += after.generateLegalMoves(opponent).empty() ? "#" : "+";
+    return san;
+}
+
+static bool insufficientMaterial(const board &position)
+{
+    int minors = 0;
+    for (int row = 0; row < 8; ++row)
+    {
+        for (int col = 0; col < 8; ++col)
+        {
+            char type = std::tolower(position.pieceAt(row, col));
+            if (type == 'p' || type == 'r' || type == 'q')
+                return false;
+            if (type == 'n' || type == 'b')
+                minors++;
+        }
+    }
+    return minors <= 1;
+}
+
+// Plays one game; engines[0] is white. Each engine has its own searcher
+// and transposition table, owned by the calling worker. After the book
+// moves, `randomPlies` uniformly random moves are played (seeded by
+// `seed`) to spread the games out. With `collectSamples`, quiet searched
+// positions are kept in record.samples.
+static gameRecord playGame(const opening &book, searcher *engines[2], transpositionTable *tables[2],
+                           const engineConfig *configs[2], int randomPlies = 0, uint32_t seed = 0,
+                           bool collectSamples = false)
+{
+    gameRecord record;
+    std::mt19937 rng(seed);
+    board position(book.fen);
+    position.setFromFEN(book.fen);
+    char player = book.player;
+
+    tables[0]->clear();
+    tables[1]->clear();
+
+    std::vector<uint64_t> history;
+    int halfmoveClock = 0;
+    int clocks[2] = {configs[0]->baseMs, configs[1]->baseMs};
+    int resignCount = 0, drawCount = 0;
+    int lastScore = 0;
+
+    auto finish = [&record](const char *result, const char *reason)
+    {
+        record.result = result;
+        record.reason = reason;
+        int8_t outcome = record.result == "1-0" ? 1 : record.result == "0-1" ? -1 : 0;
+        for (auto &sample : record.samples)
+            sample.result = outcome;
+        return record;
+    };
+    auto win = [&finish](char winner, const char *reason)
+    {
+        return finish(winner == 'w' ? "1-0" : "0-1", reason);
+    };
+
+    for (int ply = 0;; ++ply)
+    {
+        std::vector<std::string> legal = position.generateLegalMoves(player);
+        if (legal.empty())
+        {
+            if (position.isKingInCheck(player))
+                return win(opponentOf(player), "checkmate");
+            return finish("1/2-1/2", "stalemate");
+        }
+
+        uint64_t key = position.hashKey(player);
+        if (std::count(history.begin(), history.end(), key) >= 2)
+            return finish("1/2-1/2", "threefold repetition");
+        history.push_back(key);
+
+        if (halfmoveClock >= 100)
+            return finish("1/2-1/2", "fifty move rule");
+        if (insufficientMaterial(position))
+            return finish("1/2-1/2", "insufficient material");
+        if (ply >= maxPlies)
+            return finish("1/2-1/2", "move limit");
+
+        std::string move;
+        bool fromBook = ply < static_cast<int>(book.moves.size());
+        bool random = !fromBook && ply < static_cast<int>(book.moves.size()) + randomPlies;
+        int engine = (player == 'w') ? 0 : 1;
+
+        if (fromBook)
+        {
+            move = book.moves[ply];
+            if (std::find(legal.begin(), legal.end(), move) == legal.end())
+            {
+                std::cerr << "Illegal opening move " << move << "\n";
+                return finish("*", "bad opening");
+            }
+        }
+        else if (random)
+        {
+            move = legal[std::uniform_int_distribution<size_t>(0, legal.size() - 1)(rng)];
+        }
+        else
+        {
+            const engineConfig &config = *configs[engine];
+            searchLimits limits = config.limits;
+            if (config.baseMs)
+            {
+                limits.wtime = clocks[0];
+                limits.btime = clocks[1];
+                limits.winc = configs[0]->incMs;
+                limits.binc = configs[1]->incMs;
+            }
+
+            auto start = std::chrono::steady_clock::now();
+            engines[engine]->prepare();
+            searchResult result = engines[engine]->think(position, player, limits, nullptr);
+            move = result.bestMove;
+
+            if (config.baseMs)
+            {
+                // Under an NPS cap the clock runs on nodes, not wall time.
+                long long spent = limits.nps
+                                      ? static_cast<long long>(result.nodes * 1000 / limits.nps)
+                                      : std::chrono::duration_cast<std::chrono::milliseconds>(
+                                            std::chrono::steady_clock::now() - start)
+                                            .count();
+                clocks[engine] -= static_cast<int>(spent);
+                if (clocks[engine] < 0)
+                    return win(opponentOf(player), "time forfeit");
+                clocks[engine] += config.incMs;
+            }
+
+            // Both engines have to agree before a game is adjudicated.
+            int score = result.score;
+            if (std::abs(score) >= resignScore && std::abs(lastScore) >= resignScore &&
+                (score > 0) != (lastScore > 0))
+                resignCount++;
+            else
+                resignCount = 0;
+
+            if (ply >= drawStartPly && std::abs(score) <= drawScore)
+                drawCount++;
+            else
+                drawCount = 0;
+            lastScore = score;
+
+            if (resignCount >= resignPlies)
+                return win(score > 0 ? player : opponentOf(player), "adjudication");
+            if (drawCount >= drawPlies)
+                return finish("1/2-1/2", "adjudication");
+
+            // Only quiet positions with a non-mate score make good
+            // training targets for a static evaluation.
+            if (collectSamples && !position.isKingInCheck(player) && !isCapture(position, move) &&
+                move.size() == 4 && std::abs(score) < MATE_SCORE - MAX_PLY)
+            {
+                record.samples.push_back(packPosition(position, player, player == 'w' ? score : -score));
+            }
+        }
+
+        record.san.push_back(toSan(position, player, move, legal));
+
+        char piece = position.pieceAt(move[1] - '1', move[0] - 'a');
+        if (piece == 'P' || piece == 'p' || isCapture(position, move))
+            halfmoveClock = 0;
+        else
+            halfmoveClock++;
+
+        position.applyMove(move);
+        player = opponentOf(player);
+    }
+}
+
+static void writePgn(std::ostream &out, const gameRecord &record, const opening &book,
+                     const std::string &white, const std::string &black, int round)
+{
+    out << "[Event \"botDaru selfplay\"]\n"
+        << "[Site \"?\"]\n"
+        << "[Round \"" << round << "\"]\n"
+        << "[White \"" << white << "\"]\n"
+        << "[Black \"" << black << "\"]\n"
+        << "[Result \"" << record.result << "\"]\n"
+        << "[Termination \"" << record.reason << "\"]\n";
+    if (book.fen != startFen)
+        out << "[SetUp \"1\"]\n[FEN \"" << book.fen << "\"]\n";
+    out << "\n";
+
+    std::string line;
+    int moveNumber = 1;
+    bool whiteToMove = book.player == 'w';
+    for (size_t i = 0; i < record.san.size(); ++i)
+    {
+        std::string token;
+        if (whiteToMove)
+            token = std::to_string(moveNumber) + ". ";
+        else if (i == 0)
+            token = std::to_string(moveNumber) + "... ";
+        token += record.san[i];
+
+        if (!line.empty() && line.size() + token.size() + 1 > 79)
+        {
+            out << line << "\n";
+            line.clear();
+        }
+        line += (line.empty() ? "" : " ") + token;
+
+        if (!whiteToMove)
+            moveNumber++;
+        whiteToMove = !whiteToMove;
+    }
+    if (!line.empty() && line.size() + record.result.size() + 1 > 79)
+    {
+        out << line << "\n";
+        line.clear();
+    }
+    out << line << (line.empty() ? "" : " ") << record.result << "\n\n";
+}
+
+static double eloFromScore(double score)
+{
+    score = std::min(std::max(score, 1e-6), 1.0 - 1e-6);
+    return -400.0 * std::log10(1.0 / score - 1.0);
+}
+
+static double scoreFromElo(double elo)
+{
+    return 1.0 / (1.0 + std::pow(10.0, -elo / 400.0));
+}
+
+// Half a drawn game is added to the counts behind the estimates, so a
+// run of only wins or only losses still has a finite Elo, error bar and
+// LLR instead of a zero variance.
+static const double PRIOR_DRAWS = 0.5;
+
+struct matchStats {
+    int wins = 0, losses = 0, draws = 0;
+
+    int games() const { return wins + losses + draws; }
+    double score() const { return games() ? (wins + 0.5 * draws) / games() : 0.5; }
+
+    // Score for engine1 with the prior draws included.
+    double estimate() const { return (wins + 0.5 * (draws + PRIOR_DRAWS)) / (games() + PRIOR_DRAWS); }
+
+    // Per-game variance of the score for engine1, around estimate().
+    double variance() const
+    {
+        double mean = estimate();
+        return (wins * (1 - mean) * (1 - mean) + losses * mean * mean +
+                (draws + PRIOR_DRAWS) * (0.5 - mean) * (0.5 - mean)) /
+               (games() + PRIOR_DRAWS);
+    }
+
+    // Log-likelihood ratio of elo1 against elo0, normal approximation.
+    double llr(double elo0, double elo1) const
+    {
+        double var = variance();
+        if (!games() || var <= 0)
+            return 0.0;
+        double s0 = scoreFromElo(elo0), s1 = scoreFromElo(elo1);
+        return (s1 - s0) * (2 * estimate() - s0 - s1) / (2 * var) * games();
+    }
+};
+
+static void printStats(const matchStats &stats, const std::string &name1, const std::string &name2,
+                       double llr, double lower, double upper)
+{
+    double margin = 1.96 * std::sqrt(stats.variance() / std::max(1, stats.games()));
+    double elo = eloFromScore(stats.estimate());
+    double errorBar = (eloFromScore(stats.estimate() + margin) - eloFromScore(stats.estimate() - margin)) / 2;
+
+    std::cout << "Score of " << name1 << " vs " << name2 << ": "
+              << stats.wins << " - " << stats.losses << " - " << stats.draws
+              << " [" << std::fixed << std::setprecision(3) << stats.score() << "] " << stats.games() << "\n"
+              << "Elo difference: " << std::setprecision(1) << elo << " +/- " << errorBar
+              << ", LLR " << std::setprecision(2) << llr << " (" << lower << ", " << upper << ")"
+              << std::endl;
+}
+
+int runSelfplay(const std::vector<std::string> &args)
+{
+    int games = 200;
+    int concurrency = std::max(1u, std::thread::hardware_concurrency());
+    std::string openingsPath, pgnPath;
+    engineConfig configs[2];
+    configs[0].name = "engine1";
+    configs[1].name = "engine2";
+    configs[0].limits.nodes = configs[1].limits.nodes = 5000;
+    double elo0 = 0, elo1 = 5, alpha = 0.05, beta = 0.05;
+
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+        const std::string &arg = args[i];
+        bool hasValue = i + 1 < args.size();
+        std::string value = hasValue ? args[i + 1] : "";
+
+        if (!hasValue)
+        {
+            std::cerr << "Missing value for " << arg << "\n";
+            return 1;
+        }
+        ++i;
+
+        if (arg == "--games")
+            games = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--concurrency")
+            concurrency = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--openings")
+            openingsPath = value;
+        else if (arg == "--pgn")
+            pgnPath = value;
+        else if (arg == "--engine1" || arg == "--engine2")
+        {
+            engineConfig &config = configs[arg == "--engine1" ? 0 : 1];
+            // An explicit limit replaces the default node budget.
+            config.limits.nodes = 0;
+            if (!parseEngine(value, config))
+                return 1;
+            // The cap turns a time budget into nodes; without one there
+            // is nothing for it to act on.
+            if (config.limits.nps && !config.limits.movetime && !config.baseMs)
+            {
+                std::cerr << "nps needs tc or movetime in " << arg << "\n";
+                return 1;
+            }
+            if (!config.limits.depth && !config.limits.nodes && !config.limits.movetime && !config.baseMs)
+                config.limits.nodes = 5000;
+        }
+        else if (arg == "--sprt")
+        {
+            size_t comma = value.find(',');
+            elo0 = std::atof(value.substr(0, comma).c_str());
+            if (comma != std::string::npos)
+                elo1 = std::atof(value.substr(comma + 1).c_str());
+        }
+        else if (arg == "--alpha")
+            alpha = std::atof(value.c_str());
+        else if (arg == "--beta")
+            beta = std::atof(value.c_str());
+        else
+        {
+            std::cerr << "Unknown selfplay option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    std::vector<opening> openings;
+    if (!loadOpenings(openingsPath, openings))
+        return 1;
+
+    std::ofstream pgn;
+    if (!pgnPath.empty())
+    {
+        pgn.open(pgnPath, std::ios::app);
+        if (!pgn)
+        {
+            std::cerr << "Cannot open PGN file: " << pgnPath << "\n";
+            return 1;
+        }
+    }
+
+    const double lower = std::log(beta / (1 - alpha));
+    const double upper = std::log((1 - beta) / alpha);
+
+    std::mutex statsMutex;
+    matchStats stats;
+    std::atomic<int> nextGame(0);
+    std::atomic<bool> decided(false);
+    int printedGames = 0;
+
+    std::cout << "Playing " << games << " games of " << configs[0].name << " vs " << configs[1].name
+              << " on " << concurrency << " threads" << std::endl;
+
+    auto worker = [&](int index)
+    {
+        // Workers are spread over the NUMA nodes and pinned before they
+        // build their tables, so the memory they first-touch stays on
+        // their node.
+        pinThreadToNode(index);
+        transpositionTable tables[2];
+        tables[0].resize(configs[0].hashMb);
+        tables[1].resize(configs[1].hashMb);
+        searcher engine1(tables[0]), engine2(tables[1]);
+
+        for (int game = nextGame++; game < games && !decided; game = nextGame++)
+        {
+            const opening &book = openings[(game / 2) % openings.size()];
+            bool engine1White = game % 2 == 0;
+
+            searcher *engines[2] = {engine1White ? &engine1 : &engine2, engine1White ? &engine2 : &engine1};
+            transpositionTable *gameTables[2] = {engine1White ? &tables[0] : &tables[1],
+                                                 engine1White ? &tables[1] : &tables[0]};
+            const engineConfig *gameConfigs[2] = {engine1White ? &configs[0] : &configs[1],
+                                                  engine1White ? &configs[1] : &configs[0]};
+
+            gameRecord record = playGame(book, engines, gameTables, gameConfigs);
+            if (record.result == "*")
+                continue;
+
+            std::lock_guard<std::mutex> lock(statsMutex);
+            if (record.result == "1/2-1/2")
+                stats.draws++;
+            else if ((record.result == "1-0") == engine1White)
+                stats.wins++;
+            else
+                stats.losses++;
+
+            if (pgn.is_open())
+                writePgn(pgn, record, book, gameConfigs[0]->name, gameConfigs[1]->name, game + 1);
+
+            double llr = stats.llr(elo0, elo1);
+            if (stats.games() % 10 == 0)
+            {
+                printStats(stats, configs[0].name, configs[1].name, llr, lower, upper);
+                printedGames = stats.games();
+            }
+            if (llr <= lower || llr >= upper)
+                decided = true;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < concurrency; ++i)
+        threads.emplace_back(worker, i);
+    for (auto &thread : threads)
+        thread.join();
+
+    double llr = stats.llr(elo0, elo1);
+    if (stats.games() != printedGames)
+        printStats(stats, configs[0].name, configs[1].name, llr, lower, upper);
+    std::cout << "SPRT [" << elo0 << ", " << elo1 << "]: "
+              << (llr >= upper ? "H1 accepted" : llr <= lower ? "H0 accepted" : "inconclusive")
+              << std::endl;
+    return 0;
+}
+
+int runDatagen(const std::vector<std::string> &args)
+{
+    int games = 1000;
+    int concurrency = std::max(1u, std::thread::hardware_concurrency());
+    int randomPlies = 8;
+    uint32_t seed = 1;
+    std::string openingsPath, outPath;
+    engineConfig config;
+    config.name = "datagen";
+
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+        const std::string &arg = args[i];
+        if (i + 1 >= args.size())
+        {
+            std::cerr << "Missing value for " << arg << "\n";
+            return 1;
+        }
+        std::string value = args[++i];
+
+        if (arg == "--games")
+            games = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--concurrency")
+            concurrency = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--nodes")
+            config.limits.nodes = std::strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--depth")
+            config.limits.depth = std::atoi(value.c_str());
+        else if (arg == "--hash")
+            config.hashMb = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--random-plies")
+            randomPlies = std::max(0, std::atoi(value.c_str()));
+        else if (arg == "--seed")
+            seed = static_cast<uint32_t>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--openings")
+            openingsPath = value;
+        else if (arg == "--out")
+            outPath = value;
+        else
+        {
+            std::cerr << "Unknown datagen option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    if (outPath.empty())
+    {
+        std::cerr << "datagen needs --out FILE\n";
+        return 1;
+    }
+    if (!config.limits.depth && !config.limits.nodes)
+        config.limits.nodes = 2000;
+
+    std::vector<opening> openings;
+    if (!loadOpenings(openingsPath, openings))
+        return 1;
+
+    packedWriter writer(outPath);
+    if (!writer.isOpen())
+        return 1;
+
+    std::atomic<int> nextGame(0);
+    std::atomic<int> finished(0);
+    auto start = std::chrono::steady_clock::now();
+
+    std::cout << "Generating " << games << " games at ";
+    if (config.limits.depth)
+        std::cout << "depth " << config.limits.depth << (config.limits.nodes ? ", " : "");
+    if (config.limits.nodes)
+        std::cout << config.limits.nodes << " nodes";
+    std::cout << " on " << concurrency << " threads into " << outPath << std::endl;
+
+    auto worker = [&](int index)
+    {
+        pinThreadToNode(index);
+        transpositionTable tables[2];
+        tables[0].resize(config.hashMb);
+        tables[1].resize(config.hashMb);
+        searcher white(tables[0]), black(tables[1]);
+        searcher *engines[2] = {&white, &black};
+        transpositionTable *gameTables[2] = {&tables[0], &tables[1]};
+        const engineConfig *gameConfigs[2] = {&config, &config};
+
+        for (int game = nextGame++; game < games; game = nextGame++)
+        {
+            const opening &book = openings[game % openings.size()];
+            gameRecord record = playGame(book, engines, gameTables, gameConfigs, randomPlies,
+                                         seed * 2654435761u + static_cast<uint32_t>(game), true);
+            if (record.result == "*")
+                continue;
+            writer.write(record.samples);
+
+            int done = ++finished;
+            if (done % 100 == 0)
+            {
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                std::cout << "games " << done << ", positions " << writer.count()
+                          << " written, " << std::fixed << std::setprecision(1)
+                          << done / std::max(seconds, 1e-3) << " games/s" << std::endl;
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < concurrency; ++i)
+        threads.emplace_back(worker, i);
+    for (auto &thread : threads)
+        thread.join();
+
+    writer.flush();
+    std::cout << "Wrote " << writer.count() << " positions from " << finished << " games" << std::endl;
+    return 0;
+}
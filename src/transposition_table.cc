@@ -0,0 +1,123 @@
+#include "transposition_table.h"
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+static const char promotionPieces[] = " nbrq";
+
+uint16_t encodeMove(const std::string &move)
+{
+    if (move.size() < 4)
+        return 0;
+
+    int from = (move[1] - '1') * 8 + (move[0] - 'a');
+    int to = (move[3] - '1') * 8 + (move[2] - 'a');
+    int promotion = 0;
+    if (move.size() == 5)
+    {
+        const char *found = std::strchr(promotionPieces + 1, move[4]);
+        if (found)
+            promotion = static_cast<int>(found - promotionPieces);
+    }
+    return static_cast<uint16_t>(from | (to << 6) | (promotion << 12));
+}
+
+std::string decodeMove(uint16_t move)
+{
+    if (move == 0)
+        return "";
+
+    int from = move & 63;
+    int to = (move >> 6) & 63;
+    int promotion = (move >> 12) & 7;
+
+    std::string text;
+    text += static_cast<char>('a' + from % 8);
+    text += static_cast<char>('1' + from / 8);
+    text += static_cast<char>('a' + to % 8);
+    text += static_cast<char>('1' + to / 8);
+    if (promotion)
+        text += promotionPieces[promotion];
+    return text;
+}
+
+transpositionTable::transpositionTable() : table(nullptr), entryCount(0)
+{
+}
+
+transpositionTable::~transpositionTable()
+{
+    freeLarge(table, pageInfo);
+}
+
+void transpositionTable::resize(size_t megabytes)
+{
+    freeLarge(table, pageInfo);
+    table = nullptr;
+    entryCount = 0;
+
+    // Round down to a power of two so the index is a mask.
+    size_t wanted = megabytes * 1024 * 1024 / sizeof(ttEntry);
+    size_t count = 1;
+    while (count * 2 <= wanted)
+        count *= 2;
+
+    table = static_cast<ttEntry *>(allocateLarge(count * sizeof(ttEntry), pageInfo));
+    if (!table)
+    {
+        std::cerr << "Failed to allocate " << megabytes << " MB transposition table\n";
+        return;
+    }
+    entryCount = count;
+    clear();
+}
+
+void transpositionTable::clear()
+{
+    // Also the first touch of the pages, which places them on the NUMA
+    // node of the calling thread.
+    if (table)
+        std::memset(static_cast<void *>(table), 0, entryCount * sizeof(ttEntry));
+}
+
+bool transpositionTable::probe(uint64_t key, ttEntry &entry) const
+{
+    if (!entryCount)
+        return false;
+
+    const ttEntry &slot = table[key & (entryCount - 1)];
+    if (slot.key != key || slot.bound == BOUND_NONE)
+        return false;
+
+    entry = slot;
+    return true;
+}
+
+void transpositionTable::store(uint64_t key, uint16_t move, int score, int depth, uint8_t bound)
+{
+    if (!entryCount)
+        return;
+
+    ttEntry &slot = table[key & (entryCount - 1)];
+
+    // Keep a deeper result for the same position, but always let a new
+    // position take the slot.
+    if (slot.key == key && slot.depth > depth && bound != BOUND_EXACT)
+        return;
+    if (move == 0 && slot.key == key)
+        move = slot.move;
+
+    slot.key = key;
+    slot.move = move;
+    slot.score = static_cast<int16_t>(score);
+    slot.depth = static_cast<int8_t>(depth);
+    slot.bound = bound;
+}
+
+std::string transpositionTable::describe() const
+{
+    std::ostringstream out;
+    out << "Hash " << entryCount * sizeof(ttEntry) / (1024 * 1024) << " MB, "
+        << describeLarge(table, pageInfo);
+    return out.str();
+}
@@ -0,0 +1,249 @@
+#include "tuner.h"
+#include "chess_board.h"
+#include "evaluate.h"
+#include "packed_position.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+// The evaluation is linear in evalParams, so each position is reduced
+// once to its coefficient vector and a target in [0, 1].
+struct tuningSet {
+    std::vector<int16_t> coefficients; // EVAL_PARAM_COUNT per position
+    std::vector<float> targets;
+    std::vector<float> results;  // game result in [0, 1]
+    std::vector<int16_t> scores; // search score, centipawns for white
+    size_t size() const { return targets.size(); }
+};
+
+// Runs body(begin, end, thread) over [0, count) split across threads.
+static void parallelFor(int threads, size_t count, const std::function<void(size_t, size_t, int)> &body)
+{
+    std::vector<std::thread> workers;
+    size_t chunk = (count + threads - 1) / threads;
+    for (int t = 0; t < threads; ++t)
+    {
+        size_t begin = std::min(count, t * chunk);
+        size_t end = std::min(count, begin + chunk);
+        workers.emplace_back(body, begin, end, t);
+    }
+    for (auto &worker : workers)
+        worker.join();
+}
+
+static double sigmoid(double k, double eval)
+{
+    return 1.0 / (1.0 + std::pow(10.0, -k * eval / 400.0));
+}
+
+static double linearEval(const int16_t *coefficients, const std::vector<double> &weights)
+{
+    double eval = 0;
+    for (int i = 0; i < EVAL_PARAM_COUNT; ++i)
+        eval += coefficients[i] * weights[i];
+    return eval;
+}
+
+static double meanError(const tuningSet &set, const std::vector<double> &weights, double k, int threads)
+{
+    std::vector<double> partial(threads, 0.0);
+    parallelFor(threads, set.size(), [&](size_t begin, size_t end, int t)
+                {
+                    double sum = 0;
+                    for (size_t i = begin; i < end; ++i)
+                    {
+                        double error = set.targets[i] - sigmoid(k, linearEval(&set.coefficients[i * EVAL_PARAM_COUNT], weights));
+                        sum += error * error;
+                    }
+                    partial[t] = sum;
+                });
+
+    double total = 0;
+    for (double sum : partial)
+        total += sum;
+    return set.size() ? total / set.size() : 0.0;
+}
+
+// The K that best maps the current evaluation onto the targets; kept
+// fixed while tuning so the weights stay in centipawns.
+static double fitScale(const tuningSet &set, const std::vector<double> &weights, int threads)
+{
+    double low = 0.05, high = 5.0;
+    for (int i = 0; i < 40; ++i)
+    {
+        double a = low + (high - low) / 3, b = high - (high - low) / 3;
+        if (meanError(set, weights, a, threads) < meanError(set, weights, b, threads))
+            high = b;
+        else
+            low = a;
+    }
+    return (low + high) / 2;
+}
+
+static bool loadSet(const std::vector<std::string> &paths, int threads, tuningSet &set)
+{
+    for (const auto &path : paths)
+    {
+        packedFile file(path);
+        if (!file.isOpen())
+            return false;
+
+        size_t offset = set.size();
+        set.coefficients.resize((offset + file.size()) * EVAL_PARAM_COUNT);
+        set.targets.resize(offset + file.size());
+        set.results.resize(offset + file.size());
+        set.scores.resize(offset + file.size());
+
+        parallelFor(threads, file.size(), [&](size_t begin, size_t end, int)
+                    {
+                        board position("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+                        int coefficients[EVAL_PARAM_COUNT];
+                        for (size_t i = begin; i < end; ++i)
+                        {
+                            const packedPosition &packed = file.data()[i];
+                            unpackPosition(packed, position);
+                            traceEvaluation(position, coefficients);
+
+                            int16_t *out = &set.coefficients[(offset + i) * EVAL_PARAM_COUNT];
+                            for (int p = 0; p < EVAL_PARAM_COUNT; ++p)
+                                out[p] = static_cast<int16_t>(coefficients[p]);
+
+                            set.results[offset + i] = static_cast<float>((packed.result + 1) / 2.0);
+                            set.scores[offset + i] = packed.score;
+                            set.targets[offset + i] = set.results[offset + i];
+                        }
+                    });
+
+        std::cout << "Loaded " << file.size() << " positions from " << path << std::endl;
+    }
+    return set.size() > 0;
+}
+
+// Blends the search score into the targets, through the same K the
+// error uses, once K has been fitted against the results alone.
+static void blendTargets(tuningSet &set, double lambda, double k)
+{
+    for (size_t i = 0; i < set.size(); ++i)
+        set.targets[i] = static_cast<float>(lambda * set.results[i] + (1 - lambda) * sigmoid(k, set.scores[i]));
+}
+
+int runTuner(const std::vector<std::string> &args)
+{
+    int threads = std::max(1u, std::thread::hardware_concurrency());
+    int epochs = 300;
+    double rate = 1.0;
+    double lambda = 1.0;
+    std::vector<std::string> paths;
+
+    for (size_t i = 0; i < args.size(); ++i)
+    {
+        const std::string &arg = args[i];
+        if (i + 1 >= args.size())
+        {
+            std::cerr << "Missing value for " << arg << "\n";
+            return 1;
+        }
+        std::string value = args[++i];
+
+        if (arg == "--data")
+        {
+            std::istringstream list(value);
+            std::string path;
+            while (std::getline(list, path, ','))
+                paths.push_back(path);
+        }
+        else if (arg == "--threads")
+            threads = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--epochs")
+            epochs = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--rate")
+            rate = std::atof(value.c_str());
+        else if (arg == "--lambda")
+            lambda = std::min(1.0, std::max(0.0, std::atof(value.c_str())));
+        else
+        {
+            std::cerr << "Unknown tune option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    if (paths.empty())
+    {
+        std::cerr << "tune needs --data FILE\n";
+        return 1;
+    }
+
+    tuningSet set;
+    if (!loadSet(paths, threads, set))
+    {
+        std::cerr << "No positions to tune on\n";
+        return 1;
+    }
+
+    std::vector<double> weights(evalParams, evalParams + EVAL_PARAM_COUNT);
+    double k = fitScale(set, weights, threads);
+    blendTargets(set, lambda, k);
+    std::cout << "Tuning " << EVAL_PARAM_COUNT << " weights on " << set.size() << " positions, K = "
+              << std::fixed << std::setprecision(3) << k << ", error "
+              << std::setprecision(6) << meanError(set, weights, k, threads) << std::endl;
+
+    // Adam on the mean squared error of sigmoid(K * eval) against the target.
+    const double beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+    std::vector<double> momentum(EVAL_PARAM_COUNT, 0.0), velocity(EVAL_PARAM_COUNT, 0.0);
+    std::vector<std::vector<double>> partial(threads, std::vector<double>(EVAL_PARAM_COUNT));
+
+    for (int epoch = 1; epoch <= epochs; ++epoch)
+    {
+        parallelFor(threads, set.size(), [&](size_t begin, size_t end, int t)
+                    {
+                        std::vector<double> &gradient = partial[t];
+                        std::fill(gradient.begin(), gradient.end(), 0.0);
+                        for (size_t i = begin; i < end; ++i)
+                        {
+                            const int16_t *coefficients = &set.coefficients[i * EVAL_PARAM_COUNT];
+                            double s = sigmoid(k, linearEval(coefficients, weights));
+                            double slope = (s - set.targets[i]) * s * (1 - s);
+                            for (int p = 0; p < EVAL_PARAM_COUNT; ++p)
+                            {
+                                if (coefficients[p])
+                                    gradient[p] += slope * coefficients[p];
+                            }
+                        }
+                    });
+
+        double scale = 2.0 * std::log(10.0) * k / 400.0 / set.size();
+        for (int p = 0; p < EVAL_PARAM_COUNT; ++p)
+        {
+            double gradient = 0;
+            for (int t = 0; t < threads; ++t)
+                gradient += partial[t][p];
+            gradient *= scale;
+
+            momentum[p] = beta1 * momentum[p] + (1 - beta1) * gradient;
+            velocity[p] = beta2 * velocity[p] + (1 - beta2) * gradient * gradient;
+            double corrected = momentum[p] / (1 - std::pow(beta1, epoch));
+            double spread = velocity[p] / (1 - std::pow(beta2, epoch));
+            weights[p] -= rate * corrected / (std::sqrt(spread) + epsilon);
+        }
+
+        if (epoch % 25 == 0 || epoch == epochs)
+        {
+            std::cout << "epoch " << epoch << ", error " << std::setprecision(6)
+                      << meanError(set, weights, k, threads) << std::endl;
+        }
+    }
+
+    std::cout << "int evalParams[EVAL_PARAM_COUNT] = {\n";
+    for (int p = 0; p < EVAL_PARAM_COUNT; ++p)
+    {
+        std::string value = std::to_string(static_cast<int>(std::lround(weights[p]))) + ",";
+        std::cout << "    " << std::left << std::setw(5) << value << "// " << evalParamNames[p] << "\n";
+    }
+    std::cout << "};" << std::endl;
+    return 0;
+}
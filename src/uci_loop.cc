@@ -1,8 +1,12 @@
 #include "uci_loop.h"
 #include "chess_board.h"
+#include "search.h"
+#include "transposition_table.h"
+#include <cstdlib>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 void uciLoop()
@@ -11,6 +15,23 @@ void uciLoop()
     board chessBoard("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
     std::vector<std::string> moves;
 
+    transpositionTable tt;
+    tt.resize(16);
+    searcher engine(tt);
+
+    // `go` runs on its own thread so `stop` and `isready` are answered
+    // while it searches. Commands that change the engine's state stop it
+    // first, since joining a `go infinite` would block this thread.
+    std::thread searchThread;
+    auto stopSearch = [&engine, &searchThread]()
+    {
+        if (searchThread.joinable())
+        {
+            engine.stop();
+            searchThread.join();
+        }
+    };
+
     while (std::getline(std::cin, line))
     {
         std::istringstream iss(line);
@@ -19,19 +40,49 @@ void uciLoop()
 
         if (command == "uci")
         {
-            std::cout << "id name RandomUCIBot\n";
+            std::cout << "id name botDaru\n";
             std::cout << "id author YourName\n";
+            std::cout << "option name Hash type spin default 16 min 1 max 65536\n";
+            std::cout << "option name MultiPV type spin default 1 min 1 max 64\n";
             std::cout << "uciok\n";
+            // Only after the handshake; the GUI expects silence before `uci`.
+            std::cout << "info string " << tt.describe() << "\n";
         }
         else if (command == "isready")
         {
             std::cout << "readyok\n";
         }
+        else if (command == "setoption")
+        {
+            std::string token, name, value;
+            iss >> token >> name >> token >> value;
+            stopSearch();
+
+            if (name == "Hash")
+            {
+                int megabytes = std::atoi(value.c_str());
+                if (megabytes < 1)
+                    megabytes = 1;
+                tt.resize(megabytes);
+                std::cout << "info string " << tt.describe() << "\n";
+            }
+            else if (name == "MultiPV")
+            {
+                engine.setMultiPV(std::atoi(value.c_str()));
+            }
+            else
+            {
+                std::cerr << "Unknown option: " << name << "\n";
+            }
+        }
         else if (command == "ucinewgame")
         {
+            stopSearch();
+            tt.clear();
         }
         else if (command == "position")
         {
+            stopSearch();
             moves.clear();
             std::string positionType;
             iss >> positionType;
@@ -48,9 +99,16 @@ void uciLoop()
             }
             else if (positionType == "fen")
             {
-                std::string fen;
-                std::getline(iss, fen);
+                std::string fen, token;
+                while (iss >> token && token != "moves")
+                {
+                    fen += (fen.empty() ? "" : " ") + token;
+                }
                 chessBoard.setFromFEN(fen);
+                while (iss >> token)
+                {
+                    moves.push_back(token);
+                }
             }
 
             chessBoard.applyMoves(moves);
@@ -58,15 +116,44 @@ void uciLoop()
         }
         else if (command == "go")
         {
-            char player = 'w';
-            if(!moves.empty())
+            stopSearch();
+            char player = chessBoard.sideToMove();
+
+            searchLimits limits;
+            std::string token;
+            while (iss >> token)
             {
-                player = moves.size() % 2 == 0 ? 'w' : 'b';
+                if (token == "depth")
+                    iss >> limits.depth;
+                else if (token == "nodes")
+                    iss >> limits.nodes;
+                else if (token == "movetime")
+                    iss >> limits.movetime;
+                else if (token == "wtime")
+                    iss >> limits.wtime;
+                else if (token == "btime")
+                    iss >> limits.btime;
+                else if (token == "winc")
+                    iss >> limits.winc;
+                else if (token == "binc")
+                    iss >> limits.binc;
+                else if (token == "infinite")
+                    limits.infinite = true;
             }
-            auto bestMove = chessBoard.getBestMove(player);
-            std::cout << "bestmove " << bestMove << "\n";
+
+            std::cout << std::flush;
+            engine.prepare();
+            searchThread = std::thread([&engine, chessBoard, player, limits]()
+                                       {
+                                           searchResult result = engine.think(chessBoard, player, limits, &std::cout);
+                                           std::cout << "bestmove " + result.bestMove + "\n" << std::flush;
+                                       });
         }
-        else if (command == "quit" || command == "stop")
+        else if (command == "stop")
+        {
+            stopSearch();
+        }
+        else if (command == "quit")
         {
             break;
         }
@@ -75,4 +162,6 @@ void uciLoop()
             std::cerr << "Unknown command: " << command << "\n";
         }
     }
+
+    stopSearch();
 }